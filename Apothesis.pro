@@ -9,13 +9,18 @@ QT-=gui core
 QMAKE_CXXFLAGS += -std=c++17
 CONFIG += debug_and_release
 CONFING -= qt
+LIBS += -pthread
+# The profiler of the event loop (writes profile.json at the end of the run)
+#DEFINES += APOTHESIS_PROFILE
 
 INCLUDEPATH += . \
 	 ./src \
          ./src/lattice \
          ./src/processes \
          ./src/IO \
-         ./src/error
+         ./src/error \
+         ./src/engine \
+         ./src/species
 
 # Input
 HEADERS += ./src/apothesis.h \
@@ -35,7 +40,9 @@ HEADERS += ./src/apothesis.h \
            ./src/lattice/FCC.h \
            ./src/lattice/lattice.h \
            ./src/lattice/site.h \
+           ./src/lattice/site_arrays.h \
            ./src/processes/abstract_process.h \
+           ./src/processes/affected_sites.h \
            ./src/processes/desorption.h \
            ./src/processes/diffusion.h \
            ./src/processes/factory_process.h \
@@ -52,10 +59,26 @@ HEADERS += ./src/apothesis.h \
            ./src/processes/diffusion_rules.h \
            ./src/processes/diffusion_types.h \
            ./src/lattice/HCP.h \
-           ./src/lattice/diamond.h
+           ./src/lattice/diamond.h \
+           ./src/engine/sum_tree.h \
+           ./src/engine/process_selector.h \
+           ./src/engine/site_class.h \
+           ./src/engine/site_rates.h \
+           ./src/engine/cell_class.h \
+           ./src/engine/thread_pool.h \
+           ./src/engine/sublattice_engine.h \
+           ./src/engine/profiler.h \
+           ./src/IO/binary_stream.h \
+           ./src/IO/async_writer.h \
+           ./src/IO/lattice_text.h \
+           ./src/IO/trajectory.h \
+           ./src/species/species_registry.h
 
 SOURCES += ./src/apothesis.cpp \
            ./src/IO/io.cpp \
+           ./src/IO/async_writer.cpp \
+           ./src/IO/lattice_text.cpp \
+           ./src/IO/trajectory.cpp \
            ./src/IO/cml_reader.cpp \
            ./src/IO/reader.cpp \
            ./src/IO/xyz_reader.cpp \
@@ -86,4 +109,13 @@ SOURCES += ./src/apothesis.cpp \
            ./src/processes/diffusion_rules.cpp \
            ./src/processes/diffusion_types.cpp \
            ./src/lattice/HCP.cpp \
-           ./src/lattice/diamond.cpp
+           ./src/lattice/diamond.cpp \
+           ./src/engine/sum_tree.cpp \
+           ./src/engine/process_selector.cpp \
+           ./src/engine/site_class.cpp \
+           ./src/engine/site_rates.cpp \
+           ./src/engine/cell_class.cpp \
+           ./src/engine/thread_pool.cpp \
+           ./src/engine/sublattice_engine.cpp \
+           ./src/engine/profiler.cpp \
+           ./src/species/species_registry.cpp
@@ -0,0 +1,299 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+/* Benchmark of the whole kinetic engine on canonical workloads at several lattice sizes:
+ *   co      the shipped CO oxidation input.kmc (its lattice, time and output are overridden)
+ *   pvd     PVD growth of Cu by adsorption, desorption and diffusion on a flat surface
+ *   stepped the pvd case on a surface with steps
+ * Every run is a separate (forked) process which writes its input in a temporary directory, builds the
+ * simulation (the time of the constructor and init is the init time) and runs exec. The simulated time
+ * of a run is the time of the workload scaled by 64^2/L^2 so that all the sizes perform about the same
+ * number of events. The peak RSS is that of the process of the run.
+ * The results are written in JSON (to stdout or to the file given by -o) for comparing between commits.
+ *
+ * Usage: apothesis_bench [-s sizes (default 64,128,256,512,1024)] [-w workloads (default co,pvd,stepped)]
+ *                        [-t time scale (default 1)] [-i path to the CO input.kmc] [-o output file] */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "apothesis.h"
+
+#ifndef APOTHESIS_SOURCE_DIR
+#define APOTHESIS_SOURCE_DIR "."
+#endif
+
+using namespace std;
+
+/// A canonical workload. Its input is written for each lattice size.
+struct Workload {
+    string name;
+
+    /// The input without the lattice, the time and the output
+    string input;
+
+    /// The species that initially covers the lattice
+    string species;
+
+    /// The simulated time for a 64x64 lattice
+    double time;
+};
+
+/// The result of a run sent by the process of the run
+struct RunResult {
+    double initTime;
+    double execTime;
+    long events;
+};
+
+vector<string> splitList( const string& list )
+{
+    vector<string> items;
+    stringstream ss( list );
+    string item;
+    while ( getline( ss, item, ',' ) )
+        if ( !item.empty() )
+            items.push_back( item );
+    return items;
+}
+
+/// The CO oxidation workload from the shipped input. The lines of the lattice, the time and the output are removed.
+bool readCOWorkload( const string& file, Workload& w )
+{
+    ifstream in( file );
+    if ( !in.is_open() )
+        return false;
+
+    w.name = "co";
+    w.species = "X";
+    w.time = 100.0;
+
+    string line;
+    while ( getline( in, line ) ){
+        string first;
+        istringstream( line ) >> first;
+
+        if ( first == "lattice:" ){
+            //The species is the last token before a comment
+            istringstream tokens( line.substr( 0, line.find( '#' ) ) );
+            string token;
+            while ( tokens >> token )
+                w.species = token;
+            continue;
+        }
+
+        if ( first == "time_start:" || first == "time_duration:" || first == "write:" || first == "checkpoint:" || first == "restart:" )
+            continue;
+
+        w.input += line + "\n";
+    }
+
+    return true;
+}
+
+Workload pvdWorkload( const string& name, const string& steps )
+{
+    Workload w;
+    w.name = name;
+    w.species = "Cu";
+    w.time = 12.0;
+    w.input = "growth: Cu\n"
+              "temperature: 500\n"
+              "pressure: 101325\n"
+              "random: 1234\n"
+              "Cu + * -> Cu*: constant 1.0\n"
+              "Cu* -> Cu* + *: arrhenius 1.0e+13 71128 all\n"
+              "Cu* -> Cu*: constant 10.0 all\n" + steps;
+    return w;
+}
+
+/// Runs a workload in this process (the child) and returns its timings
+RunResult runWorkload( const Workload& w, int size, double timeScale )
+{
+    double time = timeScale*w.time*( 64.0*64.0 )/( (double)size*size );
+
+    ofstream input( "input.kmc" );
+    input << "lattice: SimpleCubic " << size << " " << size << " 10 " << w.species << "\n"
+          << w.input
+          << "time_duration: " << setprecision( 10 ) << time << "\n"
+          << "write: log " << time << "\n"
+          << "write: lattice " << 10*time << "\n";
+    input.close();
+
+    //The output of the simulation is not part of the report
+    freopen( "stdout.txt", "w", stdout );
+
+    char name[] = "apothesis";
+    char* argv[] = { name, nullptr };
+
+    RunResult r;
+    auto start = chrono::steady_clock::now();
+    Apothesis* apothesis = new Apothesis( 1, argv );
+    apothesis->init();
+    r.initTime = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+
+    start = chrono::steady_clock::now();
+    apothesis->exec();
+    r.execTime = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+    r.events = apothesis->getNumEvents();
+
+    delete apothesis;
+    fflush( stdout );
+
+    return r;
+}
+
+int main( int argc, char* argv[] )
+{
+    vector<string> sizes = { "64", "128", "256", "512", "1024" };
+    vector<string> names = { "co", "pvd", "stepped" };
+    double timeScale = 1.0;
+    string coInput = string( APOTHESIS_SOURCE_DIR ) + "/input.kmc";
+    string output;
+
+    int opt;
+    while ( ( opt = getopt( argc, argv, "s:w:t:i:o:" ) ) != -1 ){
+        switch ( opt ){
+        case 's': sizes = splitList( optarg ); break;
+        case 'w': names = splitList( optarg ); break;
+        case 't': timeScale = atof( optarg ); break;
+        case 'i': coInput = optarg; break;
+        case 'o': output = optarg; break;
+        default:
+            cerr << "Usage: apothesis_bench [-s sizes] [-w workloads] [-t time scale] [-i CO input.kmc] [-o output file]" << endl;
+            return 1;
+        }
+    }
+
+    vector<Workload> workloads;
+    for ( string& name:names ){
+        if ( name == "co" ){
+            Workload w;
+            if ( !readCOWorkload( coInput, w ) ){
+                cerr << "Cannot open the CO input " << coInput << " (use -i)" << endl;
+                return 1;
+            }
+            workloads.push_back( w );
+        }
+        else if ( name == "pvd" )
+            workloads.push_back( pvdWorkload( name, "" ) );
+        else if ( name == "stepped" )
+            workloads.push_back( pvdWorkload( name, "steps: 4 1\n" ) );
+        else {
+            cerr << "Unknown workload " << name << " (co, pvd or stepped)" << endl;
+            return 1;
+        }
+    }
+
+    stringstream json;
+    json << "{\n  \"benchmark\": \"apothesis_bench\",\n  \"time_scale\": " << timeScale << ",\n  \"runs\": [";
+
+    bool first = true;
+    for ( Workload& w:workloads ){
+        for ( string& s:sizes ){
+            int size = atoi( s.c_str() );
+            if ( size <= 0 || size%4 != 0 ){
+                cerr << "The lattice size must be a positive multiple of 4: " << s << endl;
+                return 1;
+            }
+
+            cerr << w.name << " " << size << "x" << size << " ... " << flush;
+
+            char dir[] = "/tmp/apothesis_bench.XXXXXX";
+            if ( !mkdtemp( dir ) ){
+                cerr << "cannot create a temporary directory" << endl;
+                return 1;
+            }
+
+            int fds[ 2 ];
+            if ( pipe( fds ) != 0 ){
+                cerr << "cannot create a pipe" << endl;
+                return 1;
+            }
+
+            pid_t pid = fork();
+            if ( pid == 0 ){
+                close( fds[ 0 ] );
+                if ( chdir( dir ) != 0 )
+                    _exit( EXIT_FAILURE );
+
+                RunResult r = runWorkload( w, size, timeScale );
+                if ( write( fds[ 1 ], &r, sizeof( r ) ) != sizeof( r ) )
+                    _exit( EXIT_FAILURE );
+                _exit( 0 );
+            }
+            close( fds[ 1 ] );
+
+            RunResult r;
+            bool received = read( fds[ 0 ], &r, sizeof( r ) ) == sizeof( r );
+            close( fds[ 0 ] );
+
+            int status = 0;
+            struct rusage usage;
+            wait4( pid, &status, 0, &usage );
+
+            bool ok = received && WIFEXITED( status ) && WEXITSTATUS( status ) == 0;
+            if ( !ok )
+                cerr << "failed (the output is kept in " << dir << ")" << endl;
+            else {
+                filesystem::remove_all( dir );
+                cerr << r.events << " events in " << r.execTime << " s" << endl;
+            }
+
+            json << ( first ? "\n" : ",\n" ) << "    { \"workload\": \"" << w.name << "\", \"size\": " << size
+                 << ", \"sites\": " << size*size;
+            first = false;
+
+            if ( !ok ){
+                json << ", \"status\": \"failed\" }";
+                continue;
+            }
+
+            //ru_maxrss is in kB on Linux
+            json << ", \"status\": \"ok\", \"events\": " << r.events << setprecision( 6 )
+                 << ", \"init_s\": " << r.initTime
+                 << ", \"exec_s\": " << r.execTime
+                 << ", \"events_per_s\": " << ( r.execTime > 0.0 ? r.events/r.execTime : 0.0 )
+                 << ", \"ns_per_event\": " << ( r.events > 0 ? 1e9*r.execTime/r.events : 0.0 )
+                 << ", \"peak_rss_kb\": " << usage.ru_maxrss << " }";
+        }
+    }
+
+    json << "\n  ]\n}\n";
+
+    if ( output.empty() )
+        cout << json.str();
+    else {
+        ofstream out( output );
+        out << json.str();
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#!/bin/bash
+# Compares the events/s of the class based engine ("engine: class") with the n-fold engine
+# ("engine: nfold") on one of two workloads:
+#   catalog  a synthetic catalog: N species that adsorb on and desorb from a L x L lattice
+#            i.e. 2N process classes, most of them holding most of the lattice.
+#   pvd      the pvd workload of apothesis_bench: PVD growth of Cu by adsorption, desorption "all"
+#            and diffusion "all" on a L x L lattice (N is not used).
+#
+# Usage: engine_bench.sh <path to apothesis> [workload (default catalog)] [N (default 100)] [L (default 100)]
+#                        [time (default 0.001 for catalog, 20 for pvd)]
+
+APOTHESIS=$(realpath "$1")
+WORKLOAD=${2:-catalog}
+N=${3:-100}
+L=${4:-100}
+
+if [ ! -x "$APOTHESIS" ] || [[ "$WORKLOAD" != "catalog" && "$WORKLOAD" != "pvd" ]]; then
+    echo "Usage: engine_bench.sh <path to apothesis> [catalog|pvd] [species] [lattice size] [time]"
+    exit 1
+fi
+
+if [ "$WORKLOAD" == "pvd" ]; then
+    TIME=${5:-20}
+else
+    TIME=${5:-0.001}
+fi
+
+WORK=$(mktemp -d)
+trap "rm -rf $WORK" EXIT
+
+write_catalog() {
+    echo "lattice: SimpleCubic $L $L 10 Cu"
+    echo "time_duration: $TIME"
+    echo "temperature: 500"
+    echo "pressure: 101325"
+    echo "random: 1234"
+    for i in $(seq 1 $N); do
+        echo "A$i + * -> A$i*: constant $(awk "BEGIN{ print 10^(($i % 7) - 3) }")"
+        echo "A$i* -> * + A$i: constant $(awk "BEGIN{ print 10^(($i % 5) - 1) }")"
+    done
+}
+
+write_pvd() {
+    echo "lattice: SimpleCubic $L $L 10 Cu"
+    echo "growth: Cu"
+    echo "time_duration: $TIME"
+    echo "temperature: 500"
+    echo "pressure: 101325"
+    echo "random: 1234"
+    echo "Cu + * -> Cu*: constant 1.0"
+    echo "Cu* -> Cu* + *: arrhenius 1.0e+13 71128 all"
+    echo "Cu* -> Cu*: constant 10.0 all"
+}
+
+write_input() {
+    write_$WORKLOAD
+    echo "write: log 1.0"
+    echo "write: lattice 100"
+    echo "$1"
+    echo "$2"
+}
+
+printf "%-24s %12s %16s\n" "engine" "events" "events/s"
+for case in "class|linear" "class|tree" "class|rejection" "nfold|tree"; do
+    engine=${case%|*}
+    selection=${case#*|}
+    dir=$WORK/$engine-$selection
+    mkdir -p $dir
+    write_input "engine: $engine" "selection: $selection" > $dir/input.kmc
+    ( cd $dir && "$APOTHESIS" > stdout.txt 2>&1 )
+    line=$(grep "Events performed" $dir/stdout.txt)
+    events=$(echo "$line" | awk '{ print $3 }')
+    rate=$(echo "$line" | sed 's/.*(\(.*\) events\/s)/\1/')
+    label=$engine
+    [ "$engine" == "class" ] && label="$engine ($selection)"
+    printf "%-24s %12s %16s\n" "$label" "$events" "$rate"
+done
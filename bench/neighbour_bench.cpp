@@ -0,0 +1,222 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+/* Micro-benchmark of the allocations made by the processes for every event.
+ * The global operator new is replaced in order to count the allocations. Each workload is built from its input
+ * on a LxL lattice (Apothesis::init) and measured in two ways:
+ *   perform  random sites and processes are drawn and the rules of the process are checked on the site
+ *            (Process::getBin); if they hold for a bin with a rate the process is performed (Process::perform).
+ *            This is the work of the processes alone: their rules read the neighbourhood and their performs
+ *            change the lattice.
+ *   exec     the whole kinetic engine runs the workload (Apothesis::exec), i.e. the performs together with the
+ *            re-evaluation of the rules of the affected sites, the selection and the output. The allocations of exec
+ *            are made by its start and end and by the output (a few for every log row), not by the events.
+ * The workloads:
+ *   pvd        PVD growth of Cu by adsorption on one and on four sites and desorption "all"
+ *   diffusion  CO adsorption, desorption and diffusion
+ *   reaction   CO oxidation (CO and dissociative O2 adsorption and the CO* + O* reaction)
+ *
+ * Usage: neighbour_bench [L (default 100)] [events (default 200000)] */
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+
+#include <unistd.h>
+
+#include "apothesis.h"
+#include "lattice.h"
+#include "process.h"
+#include "affected_sites.h"
+
+using namespace std;
+
+static long allocations = 0;
+
+void* operator new( size_t size )
+{
+    allocations++;
+    if ( void* p = malloc( size ) )
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete( void* p ) noexcept { free( p ); }
+void operator delete( void* p, size_t ) noexcept { free( p ); }
+
+/// A workload: its processes and the species that initially covers the lattice
+struct Workload {
+    string name;
+    string species;
+    string input;
+};
+
+/// The result of a measurement
+struct Result {
+    long events;
+    long allocations;
+    double seconds;
+};
+
+/// Builds the simulation of the workload in the current directory. time is the simulated time of exec (written in ten log rows).
+Apothesis* build( const Workload& w, int L, double time )
+{
+    ofstream input( "input.kmc" );
+    input << "lattice: SimpleCubic " << L << " " << L << " 10 " << w.species << "\n"
+          << w.input
+          << "temperature: 500\n"
+          << "pressure: 101325\n"
+          << "random: 1234\n"
+          << "time_duration: " << time << "\n"
+          << "write: log " << time/10.0 << "\n"
+          << "write: lattice " << 10.0*time << "\n";
+    input.close();
+
+    char name[] = "apothesis";
+    char* argv[] = { name, nullptr };
+
+    Apothesis* apothesis = new Apothesis( 1, argv );
+    apothesis->init();
+    return apothesis;
+}
+
+/// True if the engine may perform the process on the site: its rules hold and the rate constant of its bin is not zero
+bool isPerformed( MicroProcesses::Process* p, Site* s )
+{
+    int bin = p->getBin( s );
+    return bin >= 0 && p->getRateConstant( bin ) > 0.0;
+}
+
+/// Draws sites and processes until the given number of events is performed (or 100 times as many draws)
+Result measurePerform( Apothesis* apothesis, long events )
+{
+    Lattice* lattice = apothesis->pLattice;
+    const vector<MicroProcesses::Process*>& processes = apothesis->getProcesses();
+
+    mt19937 random( 1234 );
+    uniform_int_distribution<int> site( 0, lattice->getSize() - 1 );
+    uniform_int_distribution<int> process( 0, processes.size() - 1 );
+
+    //The buffers of the affected sites and of the performs grow during the first events
+    MicroProcesses::AffectedSites affected;
+    for ( long draws = 0, e = 0; e < events/10 && draws < 10*events; draws++ ){
+        Site* s = lattice->getSite( site( random ) );
+        MicroProcesses::Process* p = processes[ process( random ) ];
+        if ( isPerformed( p, s ) ){
+            p->perform( s, affected );
+            e++;
+        }
+    }
+
+    Result r = { 0, allocations, 0.0 };
+    auto start = chrono::steady_clock::now();
+    for ( long draws = 0; r.events < events && draws < 100*events; draws++ ){
+        Site* s = lattice->getSite( site( random ) );
+        MicroProcesses::Process* p = processes[ process( random ) ];
+        if ( isPerformed( p, s ) ){
+            p->perform( s, affected );
+            r.events++;
+        }
+    }
+    r.seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+    r.allocations = allocations - r.allocations;
+
+    return r;
+}
+
+/// Runs the whole engine
+Result measureExec( Apothesis* apothesis )
+{
+    Result r = { 0, allocations, 0.0 };
+    auto start = chrono::steady_clock::now();
+    apothesis->exec();
+    r.seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+    r.allocations = allocations - r.allocations;
+    r.events = apothesis->getNumEvents();
+
+    return r;
+}
+
+void report( const string& workload, const string& mode, const Result& r )
+{
+    cout << setw( 12 ) << workload << setw( 10 ) << mode << setw( 12 ) << r.events
+         << setw( 14 ) << setprecision( 4 ) << ( r.events > 0 ? 1e9*r.seconds/r.events : 0.0 ) << setw( 14 ) << r.allocations
+         << setw( 20 ) << setprecision( 4 ) << ( r.events > 0 ? (double)r.allocations/r.events : 0.0 ) << endl;
+}
+
+int main( int argc, char* argv[] )
+{
+    int L = argc > 1 ? atoi( argv[ 1 ] ) : 100;
+    long events = argc > 2 ? atol( argv[ 2 ] ) : 200000;
+
+    vector<Workload> workloads = {
+        { "pvd", "Cu", "growth: Cu\n"
+                       "Cu + * -> Cu*: constant 1.0\n"
+                       "4Cu + 4* -> 4Cu*: constant 0.5\n"
+                       "Cu* -> Cu* + *: arrhenius 1.0e+13 71128 all\n" },
+        { "diffusion", "X", "growth: CO2\n"
+                            "CO + * -> CO*: constant 1.0\n"
+                            "CO* -> * + CO: constant 0.5\n"
+                            "CO* -> CO*: constant 10.0\n" },
+        { "reaction", "X", "growth: CO2\n"
+                           "CO + * -> CO*: constant 0.4\n"
+                           "O2 + 2* -> 2O*: constant 0.15 all\n"
+                           "CO* + O* -> CO2*: constant 1.e+15\n" }
+    };
+
+    char dir[] = "/tmp/neighbour_bench.XXXXXX";
+    if ( !mkdtemp( dir ) ){
+        cerr << "Cannot create a temporary directory" << endl;
+        return 1;
+    }
+    string cwd = filesystem::current_path();
+    filesystem::current_path( dir );
+
+    //The output of the simulations is not part of the report
+    cout << setw( 12 ) << "workload" << setw( 10 ) << "mode" << setw( 12 ) << "events" << setw( 14 ) << "ns/event" << setw( 14 ) << "allocations"
+         << setw( 20 ) << "allocations/event" << endl;
+    int out = dup( fileno( stdout ) );
+    fflush( stdout );
+
+    for ( Workload& w:workloads ){
+        freopen( "stdout.txt", "w", stdout );
+        Apothesis* apothesis = build( w, L, 1.0 );
+        Result perform = measurePerform( apothesis, events );
+        delete apothesis;
+
+        apothesis = build( w, L, 1.0 );
+        Result exec = measureExec( apothesis );
+        delete apothesis;
+        fflush( stdout );
+        dup2( out, fileno( stdout ) );
+
+        report( w.name, "perform", perform );
+        report( w.name, "exec", exec );
+    }
+
+    filesystem::current_path( cwd );
+    filesystem::remove_all( dir );
+    return 0;
+}
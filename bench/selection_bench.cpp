@@ -0,0 +1,115 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+/* Micro-benchmark of the process selection engines.
+ * A synthetic catalog of processes is built with rate constants spread log-uniformly over
+ * 1e-2 ... 1e+15 and class sizes up to the number of sites of a 100x100 lattice. Each step picks
+ * a process and then changes the class size of a few processes, as an event does in exec.
+ *
+ * Usage: selection_bench [number of processes (default 128)] [steps (default 1000000)] */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#include "process_selector.h"
+#include "randomc.h"
+
+using namespace std;
+
+struct Catalog {
+    vector<double> k;
+    vector<int> size;
+};
+
+Catalog buildCatalog( int n, CRandomMersenne& rng )
+{
+    Catalog cat;
+    for ( int i = 0; i < n; i++ ){
+        cat.k.push_back( pow( 10.0, -2.0 + 17.0*rng.Random() ) );
+        cat.size.push_back( rng.IRandom( 0, 10000 ) );
+    }
+    return cat;
+}
+
+void run( Engine::ProcessSelector* selector, Catalog cat, int steps, int seed )
+{
+    int n = cat.k.size();
+    selector->resize( n );
+    for ( int i = 0; i < n; i++ )
+        selector->update( i, cat.k[ i ]*cat.size[ i ] );
+
+    CRandomMersenne stream( seed );
+    vector<long> hits( n, 0 );
+
+    auto start = chrono::steady_clock::now();
+    for ( int s = 0; s < steps; s++ ){
+        int id = selector->select( stream.Random() );
+        if ( id >= 0 )
+            hits[ id ]++;
+
+        // An event changes the classes of a few processes by one site
+        for ( int j = 0; j < 4; j++ ){
+            int p = stream.IRandom( 0, n - 1 );
+            cat.size[ p ] += ( stream.Random() < 0.5 && cat.size[ p ] > 0 ) ? -1 : 1;
+            selector->update( p, cat.k[ p ]*cat.size[ p ] );
+        }
+    }
+    double seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+
+    // The catalog drifts only slightly, so the hits of the largest process are compared with its initial share
+    int top = 0;
+    double total = 0.0;
+    for ( int i = 0; i < n; i++ ){
+        total += selector->getRate( i );
+        if ( selector->getRate( i ) > selector->getRate( top ) )
+            top = i;
+    }
+
+    cout << setw( 10 ) << selector->getName()
+         << setw( 12 ) << n
+         << setw( 16 ) << setprecision( 4 ) << steps/seconds
+         << setw( 16 ) << setprecision( 4 ) << (double)hits[ top ]/steps
+         << setw( 16 ) << setprecision( 4 ) << selector->getRate( top )/total << endl;
+}
+
+int main( int argc, char* argv[] )
+{
+    int n = argc > 1 ? atoi( argv[ 1 ] ) : 128;
+    int steps = argc > 2 ? atoi( argv[ 2 ] ) : 1000000;
+
+    CRandomMersenne rng( 1234 );
+    Catalog cat = buildCatalog( n, rng );
+
+    cout << setw( 10 ) << "selection" << setw( 12 ) << "processes" << setw( 16 ) << "selections/s"
+         << setw( 16 ) << "top hits" << setw( 16 ) << "top share" << endl;
+
+    Engine::LinearSelector linear;
+    run( &linear, cat, steps, 4321 );
+
+    Engine::TreeSelector tree;
+    run( &tree, cat, steps, 4321 );
+
+    CRandomMersenne rejectionStream( 5678 );
+    Engine::CompositionRejectionSelector rejection( [&rejectionStream](){ return rejectionStream.Random(); } );
+    run( &rejection, cat, steps, 4321 );
+
+    return 0;
+}
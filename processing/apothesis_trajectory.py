@@ -0,0 +1,250 @@
+"""Reader of the binary trajectories of Apothesis (write: trajectory <file> [delta <frames>]).
+
+The trajectory holds all the lattice snapshots of a run (see src/IO/trajectory.h for the format):
+
+    from apothesis_trajectory import Trajectory
+
+    traj = Trajectory('Trajectory.bin')
+    print(len(traj), traj.times)
+    for frame in traj:
+        heights = frame['heights']    # y x x array (numpy if available) or None
+        species = frame['species']    # y x x array of the species names ('' for an empty site) or None
+
+The frames are found from the index file (<file>.idx) or by scanning the trajectory if it is missing.
+"""
+
+import os
+import struct
+from array import array
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+TRAJECTORY_MAGIC = b'APOTRAJ\0'
+INDEX_MAGIC = b'APOTIDX\0'
+VERSION = 1
+BYTE_ORDER_MARK = 0x01020304
+FRAME_MAGIC = 0x4D415246
+
+HEIGHTS = 1
+SPECIES = 2
+RAW = 0
+DELTA = 1
+SPARSE = 2
+
+
+class Trajectory:
+    """The frames of a trajectory file."""
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, 'rb') as f:
+            header = f.read(24)
+        if len(header) < 24 or header[:8] != TRAJECTORY_MAGIC:
+            raise ValueError(path + ' is not an Apothesis trajectory')
+
+        # The byte order of the machine that wrote the trajectory
+        for order in '<>':
+            version, mark = struct.unpack(order + 'II', header[8:16])
+            if mark == BYTE_ORDER_MARK:
+                break
+        else:
+            raise ValueError('Unknown byte order in ' + path)
+        if version != VERSION:
+            raise ValueError('Unsupported trajectory version %d' % version)
+
+        self._order = order
+        self.x, self.y = struct.unpack(order + 'ii', header[16:24])
+        self._size = os.path.getsize(path)
+        self.entries = self._read_index(path + '.idx')
+        self._scan()
+        self._current = None
+        self._current_index = -1
+
+    @property
+    def times(self):
+        return [e[0] for e in self.entries]
+
+    def __len__(self):
+        return len(self.entries)
+
+    def __iter__(self):
+        for i in range(len(self.entries)):
+            yield self[i]
+
+    def __getitem__(self, i):
+        """Returns the frame i as a dict with the time, the heights, the species and the species names."""
+        if i < 0:
+            i += len(self.entries)
+        if not 0 <= i < len(self.entries):
+            raise IndexError('There is no frame %d in the trajectory' % i)
+
+        # Decoded from the last keyframe or the last decoded frame if it is on the way
+        start = i
+        while start > 0 and self.entries[start][3] != self.entries[start][2]:
+            start -= 1
+        if start <= self._current_index <= i:
+            start = self._current_index + 1
+
+        with open(self.path, 'rb') as f:
+            for k in range(start, i + 1):
+                self._current = self._decode(f, k, self._current)
+                self._current_index = k
+
+        frame = self._current
+        heights = labels = species = None
+        if frame['heights'] is not None:
+            heights = self._grid(frame['heights'])
+        if frame['labels'] is not None:
+            labels = self._grid(frame['labels'])
+            names = frame['names']
+            species = [[names[l] if l >= 0 else '' for l in row] for row in (labels.tolist() if np else labels)]
+            if np:
+                species = np.array(species, dtype=object)
+        return {'time': frame['time'], 'heights': heights, 'labels': labels, 'species': species, 'names': frame['names']}
+
+    def _grid(self, values):
+        if np:
+            return np.array(values, dtype=np.int32).reshape(self.y, self.x)
+        return [values[r * self.x:(r + 1) * self.x].tolist() for r in range(self.y)]
+
+    def _read_index(self, path):
+        entries = []
+        if not os.path.exists(path):
+            return entries
+        with open(path, 'rb') as f, open(self.path, 'rb') as t:
+            if f.read(8) != INDEX_MAGIC or struct.unpack(self._order + 'I', f.read(4))[0] != VERSION:
+                return entries
+            end = 24
+            while True:
+                data = f.read(24)
+                if len(data) < 24:
+                    break
+                entry = struct.unpack(self._order + 'dQII', data)
+                t.seek(entry[1])
+                head = t.read(12)
+                if entry[1] < end or len(head) < 12:
+                    break
+                magic, nbytes = struct.unpack(self._order + 'IQ', head)
+                if magic != FRAME_MAGIC or entry[1] + 12 + nbytes > self._size:
+                    break
+                entries.append(entry)
+                end = entry[1] + 12 + nbytes
+        return entries
+
+    def _scan(self):
+        """Finds the frames after the last one of the index."""
+        o = self._order
+        with open(self.path, 'rb') as f:
+            end = 24
+            if self.entries:
+                f.seek(self.entries[-1][1] + 4)
+                end = self.entries[-1][1] + 12 + struct.unpack(o + 'Q', f.read(8))[0]
+            while end + 12 <= self._size:
+                f.seek(end)
+                magic, nbytes = struct.unpack(o + 'IQ', f.read(12))
+                if magic != FRAME_MAGIC or end + 12 + nbytes > self._size:
+                    break
+                buf = f.read(nbytes)
+                time, planes = struct.unpack_from(o + 'dI', buf, 0)
+                pos = 12
+                if planes & SPECIES:
+                    num, = struct.unpack_from(o + 'I', buf, pos)
+                    pos += 4
+                    for _ in range(num):
+                        length, = struct.unpack_from(o + 'I', buf, pos)
+                        pos += 4 + length
+                raw = 0
+                for plane in (HEIGHTS, SPECIES):
+                    if planes & plane:
+                        encoding, pbytes = struct.unpack_from(o + 'IQ', buf, pos)
+                        pos += 12 + pbytes
+                        if encoding == RAW:
+                            raw |= plane
+                self.entries.append((time, end, planes, raw))
+                end += 12 + nbytes
+
+    def _decode(self, f, i, previous):
+        o = self._order
+        f.seek(self.entries[i][1])
+        magic, nbytes = struct.unpack(o + 'IQ', f.read(12))
+        buf = f.read(nbytes)
+        time, planes = struct.unpack_from(o + 'dI', buf, 0)
+        pos = 12
+
+        names = []
+        if planes & SPECIES:
+            num, = struct.unpack_from(o + 'I', buf, pos)
+            pos += 4
+            for _ in range(num):
+                length, = struct.unpack_from(o + 'I', buf, pos)
+                pos += 4
+                names.append(buf[pos:pos + length].decode())
+                pos += length
+
+        frame = {'time': time, 'names': names, 'heights': None, 'labels': None}
+        for plane, key in ((HEIGHTS, 'heights'), (SPECIES, 'labels')):
+            if not planes & plane:
+                continue
+            encoding, pbytes = struct.unpack_from(o + 'IQ', buf, pos)
+            pos += 12
+            data = array('i', buf[pos:pos + pbytes])
+            if o != ('<' if struct.pack('=I', 1) == struct.pack('<I', 1) else '>'):
+                data.byteswap()
+            pos += pbytes
+
+            if encoding == RAW:
+                frame[key] = data
+            elif encoding in (DELTA, SPARSE):
+                if previous is None or previous[key] is None:
+                    raise ValueError('The frame %d has no previous frame to decode from' % i)
+                values = array('i', previous[key])
+                if encoding == DELTA:
+                    # The runs of differences from the previous frame
+                    k = 0
+                    for r in range(0, len(data), 2):
+                        count, diff = data[r] & 0xFFFFFFFF, data[r + 1]
+                        if diff:
+                            for n in range(k, k + count):
+                                values[n] = (values[n] + diff + 2**31) % 2**32 - 2**31
+                        k += count
+                else:
+                    # The number of changed sites followed by (site, value) pairs
+                    for r in range(1, 1 + 2 * data[0], 2):
+                        values[data[r]] = data[r + 1]
+                frame[key] = values
+            else:
+                raise ValueError('The frame %d has an unknown encoding %d' % (i, encoding))
+        return frame
+
+
+def to_text(path, directory='.'):
+    """Writes the frames of the trajectory as the text files of the lattice snapshots (as apothesis_traj text)."""
+    traj = Trajectory(path)
+    for i in range(len(traj)):
+        traj[i]
+        frame = traj._current
+        time = frame['time']
+        for key, prefix in (('heights', 'Height'), ('labels', 'SurfaceSpecies')):
+            if frame[key] is None:
+                continue
+            with open(os.path.join(directory, '%s_%s.dat' % (prefix, _format(time, 15))), 'w') as f:
+                f.write('Time (s): %s\n' % _format(time, 6))
+                for r in range(traj.y):
+                    row = frame[key][r * traj.x:(r + 1) * traj.x]
+                    if key == 'heights':
+                        f.write(''.join('%d ' % v for v in row) + '\n')
+                    else:
+                        f.write(''.join((frame['names'][v] if v >= 0 else '') + ' ' for v in row) + '\n')
+    return len(traj)
+
+
+def _format(value, precision):
+    """Formats a double as the default format of the C++ streams with the precision."""
+    text = '%.*g' % (precision, value)
+    if 'e' in text:
+        mantissa, exponent = text.split('e')
+        text = '%se%s%02d' % (mantissa, exponent[0], int(exponent[1:]))
+    return text
@@ -0,0 +1,100 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#include "async_writer.h"
+
+namespace Utils
+{
+
+AsyncWriter::AsyncWriter( size_t maxBytes, function<void()> idle ):
+    m_iBytes(0),
+    m_iMaxBytes(maxBytes),
+    m_fIdle(idle),
+    m_bStop(false)
+{
+    m_thread = thread( &AsyncWriter::mf_run, this );
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    {
+        lock_guard<mutex> lock( m_mutex );
+        m_bStop = true;
+    }
+    m_cvWork.notify_one();
+
+    m_thread.join();
+}
+
+void AsyncWriter::push( function<void()> job, size_t bytes )
+{
+    //Every job counts so that drain waits for it
+    if ( bytes == 0 )
+        bytes = 1;
+
+    {
+        unique_lock<mutex> lock( m_mutex );
+        m_cvWritten.wait( lock, [&](){ return m_iBytes == 0 || m_iBytes + bytes <= m_iMaxBytes; } );
+
+        m_qJobs.push_back( make_pair( move( job ), bytes ) );
+        m_iBytes += bytes;
+    }
+    m_cvWork.notify_one();
+}
+
+void AsyncWriter::drain()
+{
+    unique_lock<mutex> lock( m_mutex );
+    m_cvWritten.wait( lock, [this](){ return m_iBytes == 0; } );
+}
+
+void AsyncWriter::mf_run()
+{
+    while ( true ){
+        pair< function<void()>, size_t > job;
+        {
+            unique_lock<mutex> lock( m_mutex );
+            m_cvWork.wait( lock, [this](){ return m_bStop || !m_qJobs.empty(); } );
+            if ( m_qJobs.empty() )
+                return;
+
+            job = move( m_qJobs.front() );
+            m_qJobs.pop_front();
+        }
+
+        job.first();
+
+        bool empty;
+        {
+            lock_guard<mutex> lock( m_mutex );
+            empty = m_qJobs.empty();
+        }
+
+        //The jobs written are released only after the idle function so that drain returns with the files flushed
+        if ( empty && m_fIdle )
+            m_fIdle();
+
+        {
+            lock_guard<mutex> lock( m_mutex );
+            m_iBytes -= job.second;
+        }
+        m_cvWritten.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#ifndef ASYNC_WRITER_H
+#define ASYNC_WRITER_H
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+namespace Utils
+{
+
+/** Writes the output in a background thread. The simulation thread pushes jobs that own everything they write
+ * (pre-formatted lines or copies of the lattice state) and the writer thread formats and writes them in the order
+ * they were pushed. The memory of the queued jobs is bounded: push blocks while the queue holds more bytes than the
+ * bound, so a writer that falls behind slows the simulation down instead of filling the memory. */
+class AsyncWriter
+{
+public:
+    /// Constructor. Starts the writer thread. maxBytes is the bound of the queued bytes and idle (if given)
+    /// is called by the writer thread whenever it has written all the queued jobs (e.g. for flushing the files).
+    AsyncWriter( size_t maxBytes, function<void()> idle = nullptr );
+
+    /// Destructor. Writes the queued jobs and joins the thread.
+    virtual ~AsyncWriter();
+
+    /// Queues a job of about the given bytes. Blocks while the queue is full (a job larger than the bound is queued
+    /// when the queue is empty).
+    void push( function<void()> job, size_t bytes );
+
+    /// Waits until all the queued jobs have been written.
+    void drain();
+
+private:
+    /// The loop of the writer thread: runs the jobs and calls the idle function whenever the queue empties.
+    void mf_run();
+
+    /// The jobs and their bytes
+    deque< pair< function<void()>, size_t > > m_qJobs;
+
+    /// The bytes of the queued jobs (including the one being written)
+    size_t m_iBytes;
+
+    /// The bound of the queued bytes
+    size_t m_iMaxBytes;
+
+    /// Called when the queue empties
+    function<void()> m_fIdle;
+
+    /// Protects the members above
+    mutex m_mutex;
+
+    /// Wakes the writer when there is a job or it must stop
+    condition_variable m_cvWork;
+
+    /// Wakes the simulation thread when jobs have been written
+    condition_variable m_cvWritten;
+
+    /// True when the writer must exit (after the queued jobs)
+    bool m_bStop;
+
+    /// The writer thread
+    thread m_thread;
+};
+
+}
+
+#endif // ASYNC_WRITER_H
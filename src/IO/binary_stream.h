@@ -0,0 +1,94 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef BINARY_STREAM_H
+#define BINARY_STREAM_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+using namespace std;
+
+namespace Utils
+{
+
+/** Helpers for writing and reading values in binary (native byte order) e.g. for the checkpoints.
+ * Only trivially copyable values, vectors of them and strings are supported. */
+
+/// Writes a value.
+template <class T>
+inline void writeBinary( ostream& out, const T& val )
+{
+    static_assert( is_trivially_copyable<T>::value, "Only trivially copyable values can be written in binary" );
+    out.write( reinterpret_cast<const char*>( &val ), sizeof( T ) );
+}
+
+/// Reads a value.
+template <class T>
+inline void readBinary( istream& in, T& val )
+{
+    static_assert( is_trivially_copyable<T>::value, "Only trivially copyable values can be read in binary" );
+    in.read( reinterpret_cast<char*>( &val ), sizeof( T ) );
+}
+
+/// Writes the size of the vector followed by its values.
+template <class T>
+inline void writeBinary( ostream& out, const vector<T>& vec )
+{
+    static_assert( is_trivially_copyable<T>::value, "Only vectors of trivially copyable values can be written in binary" );
+    writeBinary( out, (long)vec.size() );
+    out.write( reinterpret_cast<const char*>( vec.data() ), vec.size()*sizeof( T ) );
+}
+
+/// Reads a vector written by writeBinary.
+template <class T>
+inline void readBinary( istream& in, vector<T>& vec )
+{
+    static_assert( is_trivially_copyable<T>::value, "Only vectors of trivially copyable values can be read in binary" );
+    long size = 0;
+    readBinary( in, size );
+    if ( !in || size < 0 )
+        return;
+
+    vec.resize( size );
+    in.read( reinterpret_cast<char*>( vec.data() ), size*sizeof( T ) );
+}
+
+/// Writes the length of the string followed by its characters.
+inline void writeBinary( ostream& out, const string& str )
+{
+    writeBinary( out, (long)str.size() );
+    out.write( str.data(), str.size() );
+}
+
+/// Reads a string written by writeBinary.
+inline void readBinary( istream& in, string& str )
+{
+    long size = 0;
+    readBinary( in, size );
+    if ( !in || size < 0 )
+        return;
+
+    str.resize( size );
+    in.read( &str[ 0 ], size );
+}
+
+}
+
+#endif // BINARY_STREAM_H
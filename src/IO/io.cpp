@@ -16,9 +16,18 @@
 //============================================================================
 
 #include "io.h"
+#include "async_writer.h"
+#include "lattice_text.h"
+#include "trajectory.h"
 
 IO::IO(Apothesis* apothesis):Pointers(apothesis),
     m_sLatticeType("NONE"),
+    m_bInMemory(false),
+    m_pWriter(0),
+    m_pTrajectory(0),
+    m_bTrackChanges(false),
+    m_bChangesKnown(false),
+    m_iChangesPlanes(0),
     m_sProcess("process"),
     m_sLattice("lattice"),
     m_sTemperature("temperature"),
@@ -33,7 +42,16 @@ IO::IO(Apothesis* apothesis):Pointers(apothesis),
     m_sPrecursors("precursors"),
     m_sReport("report"),
     m_sHeights("heights.txt"),
-    m_sStartTime("time_start")
+    m_sStartTime("time_start"),
+    m_sSelection("selection"),
+    m_sEngine("engine"),
+    m_sThreads("threads"),
+    m_sResum("resum"),
+    m_sDebug("debug"),
+    m_sEnsemble("ensemble"),
+    m_sSweep("sweep"),
+    m_sCheckpoint("checkpoint"),
+    m_sRestart("restart")
 {
     //Initialize the map for the lattice
     m_mLatticeType[ "NONE" ] = Lattice::NONE;
@@ -42,7 +60,12 @@ IO::IO(Apothesis* apothesis):Pointers(apothesis),
     m_mLatticeType[ "HCP" ] = Lattice::HCP;
 }
 
-IO::~IO(){}
+IO::~IO()
+{
+    //Writes the queued output
+    delete m_pWriter;
+    delete m_pTrajectory;
+}
 
 void IO::init(int argc, char* argv[])
 {
@@ -55,7 +78,7 @@ string IO::getInputPath() const {;}
 
 void IO::readInputFile()
 {
-    list< string > lKeywords{ m_sLattice, m_sPressure, m_sTemperature, m_sTime, m_sSteps, m_sRandom, m_sSpecies, m_sWrite, m_sGrowth, m_sReport, m_sStartTime};
+    list< string > lKeywords{ m_sLattice, m_sPressure, m_sTemperature, m_sTime, m_sSteps, m_sRandom, m_sSpecies, m_sWrite, m_sGrowth, m_sReport, m_sStartTime, m_sSelection, m_sEngine, m_sThreads, m_sResum, m_sDebug, m_sEnsemble, m_sSweep, m_sCheckpoint, m_sRestart};
 
     string sLine;
     while ( getline( m_InputFile, sLine ) ) {
@@ -186,8 +209,7 @@ void IO::readInputFile()
         }
 
         if ( vsTokensBasic[ 0].compare(  m_sSteps ) == 0 ){
-            m_lattice->setSteps( true );
-
+            //The steps are built with the lattice, which is created after reading the input
             vector<string> vsTokens;
             vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
 
@@ -205,16 +227,16 @@ void IO::readInputFile()
             vector<string>::iterator it = remove_if( vsTokens.begin(), vsTokens.end(), mem_fn(&string::empty) );
             vsTokens.erase( it, vsTokens.end() );
 
-            if ( isNumber( vsTokens[ 0 ] ) ){
-                m_lattice->setNumSteps( toInt( vsTokens[ 0 ] ) );
+            if ( vsTokens.size() > 0 && isNumber( vsTokens[ 0 ] ) && toInt( vsTokens[ 0 ] ) > 0 ){
+                m_parameters->setNumSteps( toInt( vsTokens[ 0 ] ) );
             }
             else {
                 m_errorHandler->error_simple_msg("The x dimension of step is not a number.");
                 EXIT
             }
 
-            if ( isNumber( vsTokens[ 1 ] ) ){
-                m_lattice->setStepHeight( toInt( vsTokens[ 1 ] ) );
+            if ( vsTokens.size() > 1 && isNumber( vsTokens[ 1 ] ) ){
+                m_parameters->setStepHeight( toInt( vsTokens[ 1 ] ) );
             }
             else {
                 m_errorHandler->error_simple_msg("The y dimension of step is not a number.");
@@ -333,6 +355,187 @@ void IO::readInputFile()
             continue;
         }
 
+        if ( vsTokensBasic[ 0].compare( m_sSelection ) == 0){
+            vector<string> vsTokens;
+            vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
+            string selection = trim( vsTokens[ 0 ] );
+
+            if ( selection.compare("linear") != 0 && selection.compare("tree") != 0 && selection.compare("rejection") != 0 ){
+                m_errorHandler->error_simple_msg("Not correct keyword for selection. Available selections are: \"linear\", \"tree\" and \"rejection\"");
+                EXIT
+            }
+
+            m_parameters->setSelection( selection );
+            continue;
+        }
+
+        if ( vsTokensBasic[ 0].compare( m_sEngine ) == 0){
+            vector<string> vsTokens;
+            vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
+            string engine = trim( vsTokens[ 0 ] );
+
+            if ( engine.compare("class") != 0 && engine.compare("nfold") != 0 ){
+                m_errorHandler->error_simple_msg("Not correct keyword for engine. Available engines are: \"class\" and \"nfold\"");
+                EXIT
+            }
+
+            m_parameters->setEngine( engine );
+            continue;
+        }
+
+        if ( vsTokensBasic[ 0].compare( m_sThreads ) == 0){
+            vector<string> vsTokens;
+            vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
+
+            if ( isNumber( trim( vsTokens[ 0 ] ) ) && toInt( trim( vsTokens[ 0 ] ) ) > 0 ){
+                m_parameters->setThreads( toInt( trim( vsTokens[ 0 ] ) ) );
+            }
+            else {
+                m_errorHandler->error_simple_msg("Could not read the number of threads. Is it a positive number?");
+                EXIT
+            }
+
+            //The time window of the parallel engine is optional
+            if ( vsTokens.size() > 1 && !trim( vsTokens[ 1 ] ).empty() ){
+                if ( isNumber( trim( vsTokens[ 1 ] ) ) && toDouble( trim( vsTokens[ 1 ] ) ) > 0.0 )
+                    m_parameters->setWindow( toDouble( trim( vsTokens[ 1 ] ) ) );
+                else {
+                    m_errorHandler->error_simple_msg("Could not read the time window of the threads. Is it a positive number?");
+                    EXIT
+                }
+            }
+
+            continue;
+        }
+
+        if ( vsTokensBasic[ 0].compare( m_sResum ) == 0){
+            vector<string> vsTokens;
+            vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
+
+            if ( isNumber( trim( vsTokens[ 0 ] ) ) && toInt( trim( vsTokens[ 0 ] ) ) > 0 ){
+                m_parameters->setResumEvery( toInt( trim( vsTokens[ 0 ] ) ) );
+            }
+            else {
+                m_errorHandler->error_simple_msg("Could not read the number of events for resum. Is it a positive number?");
+                EXIT
+            }
+
+            continue;
+        }
+
+        if ( vsTokensBasic[ 0].compare( m_sDebug ) == 0){
+            vector<string> vsTokens;
+            vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
+            string debug = trim( vsTokens[ 0 ] );
+
+            if ( debug.compare("true") == 0 )
+                m_apothesis->setDebugMode( true );
+            else if ( debug.compare("false") == 0 )
+                m_apothesis->setDebugMode( false );
+            else {
+                m_errorHandler->error_simple_msg("Not correct keyword for debug. Available selections are: \"true\" and \"false\"");
+                EXIT
+            }
+
+            continue;
+        }
+
+        if ( vsTokensBasic[ 0].compare( m_sEnsemble ) == 0){
+            vector<string> vsTokens;
+            vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
+
+            if ( isNumber( trim( vsTokens[ 0 ] ) ) && toInt( trim( vsTokens[ 0 ] ) ) > 0 ){
+                m_parameters->setEnsemble( toInt( trim( vsTokens[ 0 ] ) ) );
+            }
+            else {
+                m_errorHandler->error_simple_msg("Could not read the number of replicas of the ensemble. Is it a positive number?");
+                EXIT
+            }
+
+            //The number of threads running the replicas is optional
+            if ( vsTokens.size() > 1 && !trim( vsTokens[ 1 ] ).empty() ){
+                if ( isNumber( trim( vsTokens[ 1 ] ) ) && toInt( trim( vsTokens[ 1 ] ) ) > 0 )
+                    m_parameters->setEnsembleThreads( toInt( trim( vsTokens[ 1 ] ) ) );
+                else {
+                    m_errorHandler->error_simple_msg("Could not read the number of threads of the ensemble. Is it a positive number?");
+                    EXIT
+                }
+            }
+
+            continue;
+        }
+
+        if ( vsTokensBasic[ 0].compare( m_sSweep ) == 0){
+            vector<string> vsTokens;
+            vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
+
+            if ( vsTokens.size() < 4 ){
+                m_errorHandler->error_simple_msg("The sweep needs a variable, a start, an end and a step e.g. sweep: temperature 600 1200 25");
+                EXIT
+            }
+
+            string variable = trim( vsTokens[ 0 ] );
+            if ( variable.compare("temperature") != 0 && variable.compare("pressure") != 0 ){
+                m_errorHandler->error_simple_msg("Not supported sweep variable: " + variable + ". Available variables are: \"temperature\" and \"pressure\"");
+                EXIT
+            }
+
+            for ( int i = 1; i < 4; i++ ){
+                if ( !isNumber( trim( vsTokens[ i ] ) ) ){
+                    m_errorHandler->error_simple_msg("Could not read the sweep of the " + variable + ". Are the start, end and step numbers?");
+                    EXIT
+                }
+            }
+
+            double start = toDouble( trim( vsTokens[ 1 ] ) );
+            double end = toDouble( trim( vsTokens[ 2 ] ) );
+            double step = toDouble( trim( vsTokens[ 3 ] ) );
+            if ( step <= 0.0 || end < start ){
+                m_errorHandler->error_simple_msg("The step of the sweep must be positive and the end not smaller than the start.");
+                EXIT
+            }
+
+            //The end is included if it is reached (within rounding) by the steps
+            vector<double> values;
+            for ( int i = 0; start + i*step <= end + 1.0e-9*step; i++ )
+                values.push_back( start + i*step );
+
+            m_parameters->setSweep( variable, values );
+            continue;
+        }
+
+        if ( vsTokensBasic[ 0].compare( m_sCheckpoint ) == 0){
+            vector<string> vsTokens;
+            vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
+
+            if ( !isNumber( trim( vsTokens[ 0 ] ) ) || toDouble( trim( vsTokens[ 0 ] ) ) <= 0.0 ){
+                m_errorHandler->error_simple_msg("Could not read every how many seconds a checkpoint is written. Is it a positive number?");
+                EXIT
+            }
+
+            //The file is optional
+            string file = "checkpoint.bin";
+            if ( vsTokens.size() > 1 && !trim( vsTokens[ 1 ] ).empty() )
+                file = trim( vsTokens[ 1 ] );
+
+            m_parameters->setCheckpoint( toDouble( trim( vsTokens[ 0 ] ) ), file );
+            continue;
+        }
+
+        if ( vsTokensBasic[ 0].compare( m_sRestart ) == 0){
+            vector<string> vsTokens;
+            vsTokens = split( vsTokensBasic[ 1 ], string( " " ) );
+            string file = trim( vsTokens[ 0 ] );
+
+            if ( !ifstream( file ).good() ){
+                m_errorHandler->error_simple_msg("The checkpoint file " + file + " does not exist.");
+                EXIT
+            }
+
+            m_parameters->setRestartFile( file );
+            continue;
+        }
+
         if ( vsTokensBasic[ 0].compare( m_sRandom ) == 0){
             m_parameters->setRandGenInit( toDouble( trim(vsTokensBasic[ 1] ) ) );
             continue;
@@ -375,8 +578,35 @@ void IO::readInputFile()
                     EXIT
                 }
             }
+            else if ( vsTokens[ 0 ].compare( "queue") == 0 ) {
+                if ( vsTokens.size() > 1 && isNumber( trim(vsTokens[ 1 ] ) ) && toInt( trim(vsTokens[ 1 ] ) ) >= 0 ){
+                    m_parameters->setWriteQueueSize( toInt( trim(vsTokens[ 1 ] ) ) );
+                }
+                else {
+                    m_errorHandler->error_simple_msg("Could not read the size (MB) of the output queue. Is it a positive number or zero?");
+                    EXIT
+                }
+            }
+            else if ( vsTokens[ 0 ].compare( "trajectory") == 0 ) {
+                //write: trajectory <file> [delta <frames between keyframes>]
+                if ( vsTokens.size() > 1 )
+                    m_parameters->setTrajectoryFile( trim( vsTokens[ 1 ] ) );
+                else {
+                    m_errorHandler->error_simple_msg("The file of the trajectory is missing.");
+                    EXIT
+                }
+
+                if ( vsTokens.size() > 2 ){
+                    if ( vsTokens[ 2 ].compare( "delta" ) == 0 && vsTokens.size() > 3 && isNumber( trim( vsTokens[ 3 ] ) ) && toInt( trim( vsTokens[ 3 ] ) ) >= 1 )
+                        m_parameters->setTrajectoryKeyframes( toInt( trim( vsTokens[ 3 ] ) ) );
+                    else {
+                        m_errorHandler->error_simple_msg("Could not read the frames between the keyframes of the trajectory. The syntax is \"trajectory <file> delta <frames>\".");
+                        EXIT
+                    }
+                }
+            }
             else {
-                m_errorHandler->error_simple_msg("Not correct keyword for writer. Available selections are: \"log\" and \"lattice\"");
+                m_errorHandler->error_simple_msg("Not correct keyword for writer. Available selections are: \"log\", \"lattice\", \"queue\" and \"trajectory\"");
                 EXIT
             }
 
@@ -664,11 +894,16 @@ bool IO::contains(string str1, string str2, CASE cas )
 }
 
 /// Opens the output file
-bool IO::openOutputFile( string name )
+bool IO::openOutputFile( string name, bool append )
 {
-    m_OutFile.open( name + ".log" , ios::out );
-    if ( m_OutFile.is_open() )
+    m_OutFile.open( name + ".log" , append ? ios::out | ios::app : ios::out );
+    if ( m_OutFile.is_open() ){
+        //The output is written by a background thread unless its queue is set to zero
+        if ( !m_pWriter && m_parameters->getWriteQueueSize() > 0 )
+            m_pWriter = new Utils::AsyncWriter( (size_t)m_parameters->getWriteQueueSize()*1024*1024, [this](){ m_OutFile.flush(); } );
+
         return true;
+    }
 
     m_errorHandler->error_simple_msg( "Cannot open file log for writting." ) ;
     exit(-1);
@@ -678,18 +913,55 @@ bool IO::openOutputFile( string name )
 
 void IO::writeInOutput( string toWrite )
 {
+    if ( m_bInMemory ){
+        m_vOutputLines.push_back( toWrite );
+        return;
+    }
+
+    if ( m_pWriter ){
+        size_t bytes = toWrite.size();
+        m_pWriter->push( [this, line = move( toWrite )](){ m_OutFile << line << '\n'; }, bytes );
+        return;
+    }
+
     m_OutFile << toWrite << endl;
     m_OutFile.flush();
 }
 
 void IO::closeOutputFile()
 {
+    delete m_pWriter;
+    m_pWriter = 0;
+
+    delete m_pTrajectory;
+    m_pTrajectory = 0;
+
     if ( m_OutFile.is_open( ) )
         m_OutFile.close();
 }
 
+void IO::flush()
+{
+    //The trajectory is flushed after each frame
+    if ( m_pWriter )
+        m_pWriter->drain();
+    else
+        m_OutFile.flush();
+}
+
 void IO::writeLogOutput( string str )
 {
+    if ( m_bInMemory ){
+        m_vOutputLines.push_back( str );
+        return;
+    }
+
+    if ( m_pWriter ){
+        size_t bytes = str.size();
+        m_pWriter->push( [this, line = move( str )](){ m_OutFile << line << '\n'; }, bytes );
+        return;
+    }
+
     m_OutFile << str << endl;
 }
 
@@ -706,46 +978,137 @@ void IO::writeLatticeInfo()
         m_OutFile << "Lattice type: " << "FCC";
 }
 
-void IO::writeLatticeHeights( double time  )
+void IO::openTrajectory( string file, bool restarted, double time )
 {
-    ostringstream streamObj;
-    //Add double to stream
-    streamObj.precision(15);
-    streamObj << time;
+    if ( m_bInMemory )
+        return;
 
-    std::string name="Height_" + streamObj.str() + ".dat";
-    std::ofstream file(name);
+    //A restarted run continues the trajectory after the frames of the checkpointed run up to time
+    m_pTrajectory = new Utils::TrajectoryWriter();
+    if ( !m_pTrajectory->open( file, m_lattice->getX(), m_lattice->getY(), m_parameters->getTrajectoryKeyframes(), restarted, time ) ){
+        m_errorHandler->error_simple_msg( m_pTrajectory->getError() );
+        EXIT
+    }
 
-    file << "Time (s): " << time << endl;
+    //The delta frames hold only the sites changed by the events since the previous frame (the first frame is written whole)
+    m_bTrackChanges = m_parameters->getTrajectoryKeyframes() > 1;
+    m_bChangesKnown = false;
+}
 
-    for (int i = 0; i < m_lattice->getY(); i++){
-        for (int j = 0; j < m_lattice->getX(); j++)
-            file << m_lattice->getSite( i*m_lattice->getX() + j )->getHeight() << " " ;
+void IO::writeLattice( double time, bool heights, bool species )
+{
+    if ( m_bInMemory )
+        return;
+
+    if ( !m_pTrajectory ){
+        if ( heights )
+            writeLatticeHeights( time );
+
+        if ( species )
+            writeLatticeSpecies( time );
+
+        return;
+    }
+
+    uint32_t planes = ( heights ? TrajectoryWriter::HEIGHTS : 0 ) | ( species ? TrajectoryWriter::SPECIES : 0 );
+    vector<string> names;
+    if ( species )
+        for ( int id = 0; id < SpeciesRegistry::size(); id++ )
+            names.push_back( SpeciesRegistry::getName( id ) );
+
+    const SiteArrays& arrays = m_lattice->getArrays();
+
+    //Only the changed sites are copied (in the order of their IDs). The delta frame needs a previous frame with the
+    //same planes, otherwise the frame is written whole
+    if ( m_bTrackChanges && m_bChangesKnown && planes == m_iChangesPlanes ){
+        vector<int> sites, h, l;
+        for ( Site* s:m_Changed )
+            sites.push_back( s->getID() );
+        sort( sites.begin(), sites.end() );
+
+        for ( int id:sites ){
+            if ( heights )
+                h.push_back( arrays.heights[ id ] );
+            if ( species )
+                l.push_back( arrays.labels[ id ] );
+        }
+        m_Changed.clear();
+
+        if ( m_pWriter ){
+            size_t bytes = ( sites.size() + h.size() + l.size() )*sizeof( int );
+            m_pWriter->push( [this, time, planes, sites = move( sites ), h = move( h ), l = move( l ), names = move( names )](){
+                m_pTrajectory->writeChanges( time, planes, sites, h, l, names ); }, bytes );
+        }
+        else
+            m_pTrajectory->writeChanges( time, planes, sites, h, l, names );
+
+        return;
+    }
+
+    if ( m_bTrackChanges ){
+        m_Changed.clear();
+        m_bChangesKnown = true;
+        m_iChangesPlanes = planes;
+    }
 
-        file << endl;
+    //The writer encodes copies of the planes
+    if ( m_pWriter ){
+        vector<int> h, l;
+        if ( heights )
+            h = arrays.heights;
+        if ( species )
+            l = arrays.labels;
+
+        size_t bytes = ( h.size() + l.size() )*sizeof( int );
+        m_pWriter->push( [this, time, planes, h = move( h ), l = move( l ), names = move( names )](){
+            m_pTrajectory->writeFrame( time, planes, h, l, names ); }, bytes );
+        return;
     }
+
+    m_pTrajectory->writeFrame( time, planes, arrays.heights, arrays.labels, names );
 }
 
+void IO::writeLatticeHeights( double time  )
+{
+    if ( m_bInMemory )
+        return;
+
+    string name = latticeFileName( "Height", time );
+
+    //The writer formats a copy of the heights
+    if ( m_pWriter ){
+        vector<int> heights = m_lattice->getArrays().heights;
+        size_t bytes = heights.size()*sizeof( int );
+        int x = m_lattice->getX(), y = m_lattice->getY();
+        m_pWriter->push( [name, time, x, y, heights = move( heights )](){ writeHeightsText( name, time, x, y, heights ); }, bytes );
+        return;
+    }
+
+    writeHeightsText( name, time, m_lattice->getX(), m_lattice->getY(), m_lattice->getArrays().heights );
+}
 
 void IO::writeLatticeSpecies( double time  )
 {
-    // Create an output string stream
-    ostringstream streamObj;
-    //Add double to stream
-    streamObj.precision(15);
-    streamObj << time;
-
-    std::string name="SurfaceSpecies_" + streamObj.str() + ".dat";
-    std::ofstream file(name);
-    file << "Time (s): " << time << endl;
-    file.precision(10);
-
-    for (int i = 0; i < m_lattice->getY(); i++){
-        for (int j = 0; j < m_lattice->getX(); j++)
-            file << m_lattice->getSite( i*m_lattice->getX() + j )->getLabel() << " " ;
-
-        file << endl;
+    if ( m_bInMemory )
+        return;
+
+    string name = latticeFileName( "SurfaceSpecies", time );
+
+    vector<string> names;
+    for ( int id = 0; id < SpeciesRegistry::size(); id++ )
+        names.push_back( SpeciesRegistry::getName( id ) );
+
+    //The writer formats a copy of the species
+    if ( m_pWriter ){
+        vector<int> labels = m_lattice->getArrays().labels;
+        size_t bytes = labels.size()*sizeof( int );
+        int x = m_lattice->getX(), y = m_lattice->getY();
+        m_pWriter->push( [name, time, x, y, labels = move( labels ), names = move( names )](){
+            writeSpeciesText( name, time, x, y, labels, names ); }, bytes );
+        return;
     }
+
+    writeSpeciesText( name, time, m_lattice->getX(), m_lattice->getY(), m_lattice->getArrays().labels, names );
 }
 
 string IO::GetCurrentWorkingDir()
@@ -26,6 +26,7 @@
 #include <map>
 #include <algorithm>
 #include <sstream>
+#include <cstdint>
 
 
 #include "pointers.h"
@@ -34,6 +35,7 @@
 
 #include "errorhandler.h"
 #include "parameters.h"
+#include "affected_sites.h"
 
 #if defined( _WIN32) || defined( _WIN64)
 #include <direct.h>
@@ -54,6 +56,7 @@ using namespace Utils;
 
 class Pointers;
 //class Parameters;
+namespace Utils { class AsyncWriter; class TrajectoryWriter; }
 
 class IO: public Pointers
   {
@@ -89,8 +92,8 @@ class IO: public Pointers
     /// Opens the input file.
     void openInputFile(string file);
 
-    /// Opens the output file with the name name.
-    bool openOutputFile( string name );
+    /// Opens the output file with the name name. If append is true the output is added at the end of the file.
+    bool openOutputFile( string name, bool append = false );
 
     /// Write in the output file.
     void writeInOutput( string );
@@ -154,6 +157,23 @@ class IO: public Pointers
     /// Write lattice info.
     void writeLatticeInfo();
 
+    /// Opens the trajectory file for the lattice snapshots. A restarted run continues it from time.
+    void openTrajectory( string file, bool restarted, double time );
+
+    /// Writes a snapshot of the heights and/or the species of the lattice: a frame of the trajectory if it is open,
+    /// else the text files of writeLatticeHeights and writeLatticeSpecies.
+    void writeLattice( double time, bool heights, bool species );
+
+    /// Marks the sites changed by an event: the next frame of a trajectory with delta frames holds only them
+    inline void trackChanges( const MicroProcesses::AffectedSites& affected ){
+        if ( m_bTrackChanges )
+            for ( Site* s:affected )
+                m_Changed.add( s );
+    }
+
+    /// The changed sites are not known (e.g. they were changed by the threads): the next frame is written whole
+    inline void invalidateChanges(){ m_bChangesKnown = false; }
+
     /// Write the height of each site
     void writeLatticeHeights( double time );
 
@@ -169,6 +189,16 @@ class IO: public Pointers
     /// Check if Output file is open
     bool outputOpen();
 
+    /// Waits until the queued output has been written and flushed (e.g. before writing a checkpoint)
+    void flush();
+
+    /// If true the output and log lines are kept in memory instead of the output file and the lattice files are not written
+    /// (used by the replicas of an ensemble)
+    inline void setInMemory( bool inMemory ){ m_bInMemory = inMemory; }
+
+    /// Returns the output and log lines kept in memory
+    inline const vector<string>& getOutputLines() const { return m_vOutputLines; }
+
     /// Open roughness file for writting the roughness
     void openRoughnessFile( string );
 
@@ -213,6 +243,30 @@ class IO: public Pointers
     /// The rpughness file
     ofstream m_RoughnessFile;
 
+    /// True if the output is kept in memory
+    bool m_bInMemory;
+
+    /// The output and log lines kept in memory
+    vector<string> m_vOutputLines;
+
+    /// Writes the output in a background thread (null if the output is written by the simulation thread)
+    Utils::AsyncWriter* m_pWriter;
+
+    /// The trajectory of the lattice snapshots (null if they are written in text files)
+    Utils::TrajectoryWriter* m_pTrajectory;
+
+    /// True if the changed sites are tracked (a trajectory with delta frames)
+    bool m_bTrackChanges;
+
+    /// True if the changed sites since the last frame are known
+    bool m_bChangesKnown;
+
+    /// The planes of the frames written since the changed sites are known
+    uint32_t m_iChangesPlanes;
+
+    /// The sites changed since the last frame
+    MicroProcesses::AffectedSites m_Changed;
+
     /// Keywords:
     /// Process keyword
     string m_sProcess;
@@ -259,6 +313,33 @@ class IO: public Pointers
     /// The keyword for storing the start time.
     string m_sStartTime ;
 
+    /// The keyword for the selection engine of the processes.
+    string m_sSelection;
+
+    /// The keyword for the kinetic engine.
+    string m_sEngine;
+
+    /// The keyword for the number of threads.
+    string m_sThreads;
+
+    /// The keyword for the number of events between full summations of the total rate.
+    string m_sResum;
+
+    /// The keyword for the debug mode.
+    string m_sDebug;
+
+    /// The keyword for the number of replicas of the ensemble.
+    string m_sEnsemble;
+
+    /// The keyword for the sweep over the temperature or the pressure.
+    string m_sSweep;
+
+    /// The keyword for writing checkpoints.
+    string m_sCheckpoint;
+
+    /// The keyword for continuing from a checkpoint.
+    string m_sRestart;
+
     // trim from start (in place)
     static inline void ltrim(std::string &s) {
         s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) {
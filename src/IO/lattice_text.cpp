@@ -0,0 +1,79 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#include "lattice_text.h"
+
+#include <fstream>
+#include <sstream>
+#include <charconv>
+
+namespace Utils
+{
+
+string latticeFileName( const string& prefix, double time )
+{
+    ostringstream streamObj;
+    streamObj.precision(15);
+    streamObj << time;
+
+    return prefix + "_" + streamObj.str() + ".dat";
+}
+
+void writeHeightsText( const string& name, double time, int x, int y, const vector<int>& heights )
+{
+    std::ofstream file(name);
+
+    file << "Time (s): " << time << endl;
+
+    //Each row is formatted in a buffer and written at once
+    string row;
+    char number[ 16 ];
+    for (int i = 0; i < y; i++){
+        row.clear();
+        for (int j = 0; j < x; j++){
+            row.append( number, to_chars( number, number + sizeof( number ), heights[ i*x + j ] ).ptr );
+            row += ' ';
+        }
+
+        row += '\n';
+        file.write( row.data(), row.size() );
+    }
+}
+
+void writeSpeciesText( const string& name, double time, int x, int y, const vector<int>& labels, const vector<string>& names )
+{
+    std::ofstream file(name);
+    file << "Time (s): " << time << endl;
+
+    //Each row is formatted in a buffer and written at once (a negative label is an empty site)
+    string row;
+    for (int i = 0; i < y; i++){
+        row.clear();
+        for (int j = 0; j < x; j++){
+            int label = labels[ i*x + j ];
+            if ( label >= 0 )
+                row += names[ label ];
+            row += ' ';
+        }
+
+        row += '\n';
+        file.write( row.data(), row.size() );
+    }
+}
+
+}
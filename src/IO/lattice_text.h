@@ -0,0 +1,44 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#ifndef LATTICE_TEXT_H
+#define LATTICE_TEXT_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace Utils
+{
+
+/** The text format of the lattice snapshots: a file per snapshot (e.g. Height_0.5.dat) with the time in the first line
+ * followed by a row of values for each row of the lattice. Used by the IO and the trajectory converter. */
+
+/// Returns the name of the snapshot file for the time (e.g. Height_0.5.dat for the prefix Height).
+string latticeFileName( const string& prefix, double time );
+
+/// Writes the heights of an x * y lattice in the file name
+void writeHeightsText( const string& name, double time, int x, int y, const vector<int>& heights );
+
+/// Writes the species of an x * y lattice in the file name. names are the names of the species by their ID.
+void writeSpeciesText( const string& name, double time, int x, int y, const vector<int>& labels, const vector<string>& names );
+
+}
+
+#endif // LATTICE_TEXT_H
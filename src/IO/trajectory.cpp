@@ -0,0 +1,612 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#include "trajectory.h"
+
+#include <cstring>
+#include <filesystem>
+
+namespace Utils
+{
+
+namespace
+{
+
+const char TRAJECTORY_MAGIC[ 8 ] = { 'A', 'P', 'O', 'T', 'R', 'A', 'J', '\0' };
+const char INDEX_MAGIC[ 8 ] = { 'A', 'P', 'O', 'T', 'I', 'D', 'X', '\0' };
+const uint32_t TRAJECTORY_VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const uint32_t FRAME_MAGIC = 0x4D415246; // "FRAM"
+
+/// The bytes of the header of the trajectory and the index files
+const uint64_t TRAJECTORY_HEADER = 24;
+const uint64_t INDEX_HEADER = 12;
+
+/// The bytes of the magic and the size of a frame
+const uint64_t FRAME_HEADER = 12;
+
+/// Appends a value to a buffer
+template <class T>
+inline void append( string& buf, const T& val )
+{
+    buf.append( reinterpret_cast<const char*>( &val ), sizeof( T ) );
+}
+
+/// Reads a value from a buffer at pos and advances pos. Returns false if the buffer is too short.
+template <class T>
+inline bool take( const string& buf, size_t& pos, T& val )
+{
+    if ( pos + sizeof( T ) > buf.size() )
+        return false;
+
+    memcpy( &val, buf.data() + pos, sizeof( T ) );
+    pos += sizeof( T );
+    return true;
+}
+
+template <class T>
+inline void writeValue( ostream& out, const T& val )
+{
+    out.write( reinterpret_cast<const char*>( &val ), sizeof( T ) );
+}
+
+template <class T>
+inline bool readValue( istream& in, T& val )
+{
+    return (bool)in.read( reinterpret_cast<char*>( &val ), sizeof( T ) );
+}
+
+/// Writes an index entry
+void writeEntry( ostream& out, const TrajectoryReader::Entry& entry )
+{
+    writeValue( out, entry.time );
+    writeValue( out, entry.offset );
+    writeValue( out, entry.planes );
+    writeValue( out, entry.rawPlanes );
+}
+
+}
+
+//------------------------------------------------------------------------------------------------------------------//
+
+TrajectoryWriter::TrajectoryWriter():
+    m_iOffset(0),
+    m_iKeyframes(1),
+    m_iSinceKeyframe(0),
+    m_bHasPrevious(false)
+{}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    close();
+}
+
+bool TrajectoryWriter::open( const string& file, int x, int y, int keyframes, bool append, double time )
+{
+    close();
+
+    m_iKeyframes = keyframes;
+    m_iSinceKeyframe = 0;
+    m_bHasPrevious = false;
+    m_Previous = TrajectoryFrame();
+
+    string indexFile = file + ".idx";
+
+    if ( append && filesystem::exists( file ) ){
+        vector<TrajectoryReader::Entry> entries;
+        uint64_t cut = 0;
+        {
+            TrajectoryReader reader;
+            if ( !reader.open( file ) ){
+                m_sError = reader.getError();
+                return false;
+            }
+
+            if ( reader.getX() != x || reader.getY() != y ){
+                m_sError = "The trajectory " + file + " is for a " + to_string( reader.getX() ) + " x " + to_string( reader.getY() ) + " lattice.";
+                return false;
+            }
+
+            //The frames later than time are removed
+            entries = reader.getEntries();
+            cut = reader.getEnd();
+            for ( int i = 0; i < entries.size(); i++ ){
+                if ( entries[ i ].time > time ){
+                    cut = entries[ i ].offset;
+                    entries.resize( i );
+                    break;
+                }
+            }
+        }
+
+        error_code error;
+        filesystem::resize_file( file, cut, error );
+        if ( error ){
+            m_sError = "Cannot truncate the trajectory " + file + ": " + error.message();
+            return false;
+        }
+
+        //The index is written again (this also recovers a missing or incomplete one)
+        m_Index.open( indexFile, ios::binary | ios::trunc );
+        m_Index.write( INDEX_MAGIC, sizeof( INDEX_MAGIC ) );
+        writeValue( m_Index, TRAJECTORY_VERSION );
+        for ( const TrajectoryReader::Entry& entry:entries )
+            writeEntry( m_Index, entry );
+
+        m_File.open( file, ios::binary | ios::app );
+        m_iOffset = cut;
+    }
+    else {
+        m_File.open( file, ios::binary | ios::trunc );
+        m_File.write( TRAJECTORY_MAGIC, sizeof( TRAJECTORY_MAGIC ) );
+        writeValue( m_File, TRAJECTORY_VERSION );
+        writeValue( m_File, BYTE_ORDER_MARK );
+        writeValue( m_File, (int32_t)x );
+        writeValue( m_File, (int32_t)y );
+
+        m_Index.open( indexFile, ios::binary | ios::trunc );
+        m_Index.write( INDEX_MAGIC, sizeof( INDEX_MAGIC ) );
+        writeValue( m_Index, TRAJECTORY_VERSION );
+
+        m_iOffset = TRAJECTORY_HEADER;
+    }
+
+    if ( !m_File || !m_Index ){
+        m_sError = "Cannot open the trajectory " + file + " for writing.";
+        close();
+        return false;
+    }
+
+    flush();
+    return true;
+}
+
+void TrajectoryWriter::writeFrame( double time, uint32_t planes, const vector<int>& heights, const vector<int>& labels, const vector<string>& names )
+{
+    //The DELTA encoding needs the same planes in the previous frame
+    bool keyframe = !m_bHasPrevious || m_iKeyframes <= 1 || m_iSinceKeyframe >= m_iKeyframes || m_Previous.planes != planes;
+
+    string& buf = m_sBuffer;
+    mf_writeHeader( buf, time, planes, names );
+
+    uint32_t rawPlanes = 0;
+    if ( planes & HEIGHTS && mf_writePlane( buf, heights, keyframe ? nullptr : &m_Previous.heights ) == RAW )
+        rawPlanes |= HEIGHTS;
+
+    if ( planes & SPECIES && mf_writePlane( buf, labels, keyframe ? nullptr : &m_Previous.labels ) == RAW )
+        rawPlanes |= SPECIES;
+
+    mf_writeFrame( buf, time, planes, rawPlanes );
+
+    m_Previous.planes = planes;
+    if ( planes & HEIGHTS )
+        m_Previous.heights = heights;
+    if ( planes & SPECIES )
+        m_Previous.labels = labels;
+    m_bHasPrevious = true;
+}
+
+void TrajectoryWriter::writeChanges( double time, uint32_t planes, const vector<int>& sites, const vector<int>& heights, const vector<int>& labels,
+                                     const vector<string>& names )
+{
+    if ( !m_bHasPrevious || m_Previous.planes != planes ){
+        m_sError = "The frame at " + to_string( time ) + " has no previous frame with the same planes and is not written.";
+        return;
+    }
+
+    bool keyframe = m_iSinceKeyframe >= m_iKeyframes;
+
+    string& buf = m_sBuffer;
+    mf_writeHeader( buf, time, planes, names );
+
+    uint32_t rawPlanes = 0;
+    if ( planes & HEIGHTS && mf_writeChanges( buf, m_Previous.heights, sites, heights, keyframe ) == RAW )
+        rawPlanes |= HEIGHTS;
+
+    if ( planes & SPECIES && mf_writeChanges( buf, m_Previous.labels, sites, labels, keyframe ) == RAW )
+        rawPlanes |= SPECIES;
+
+    mf_writeFrame( buf, time, planes, rawPlanes );
+}
+
+void TrajectoryWriter::mf_writeHeader( string& buf, double time, uint32_t planes, const vector<string>& names )
+{
+    buf.clear();
+    append( buf, time );
+    append( buf, planes );
+
+    if ( planes & SPECIES ){
+        append( buf, (uint32_t)names.size() );
+        for ( const string& name:names ){
+            append( buf, (uint32_t)name.size() );
+            buf += name;
+        }
+    }
+}
+
+void TrajectoryWriter::mf_writeFrame( const string& buf, double time, uint32_t planes, uint32_t rawPlanes )
+{
+    writeValue( m_File, FRAME_MAGIC );
+    writeValue( m_File, (uint64_t)buf.size() );
+    m_File.write( buf.data(), buf.size() );
+
+    TrajectoryReader::Entry entry{ time, m_iOffset, planes, rawPlanes };
+    writeEntry( m_Index, entry );
+    m_iOffset += FRAME_HEADER + buf.size();
+
+    //A frame is complete in the files when it is written (e.g. for reading it during the run)
+    flush();
+
+    m_iSinceKeyframe = rawPlanes == planes ? 1 : m_iSinceKeyframe + 1;
+}
+
+uint32_t TrajectoryWriter::mf_writePlane( string& buf, const vector<int>& plane, const vector<int>* previous )
+{
+    size_t start = buf.size();
+    uint64_t rawBytes = plane.size()*sizeof( int32_t );
+
+    if ( previous && previous->size() == plane.size() ){
+        append( buf, (uint32_t)DELTA );
+        append( buf, (uint64_t)0 );
+
+        //The runs of equal differences (computed as unsigned for not overflowing)
+        uint64_t bytes = 0;
+        for ( size_t i = 0; i < plane.size() && bytes < rawBytes; ){
+            int32_t diff = (int32_t)( (uint32_t)plane[ i ] - (uint32_t)( *previous )[ i ] );
+            uint32_t count = 1;
+            for ( i++; i < plane.size() && (int32_t)( (uint32_t)plane[ i ] - (uint32_t)( *previous )[ i ] ) == diff; i++ )
+                count++;
+
+            append( buf, count );
+            append( buf, diff );
+            bytes += sizeof( count ) + sizeof( diff );
+        }
+
+        if ( bytes < rawBytes ){
+            memcpy( &buf[ start + sizeof( uint32_t ) ], &bytes, sizeof( bytes ) );
+            return DELTA;
+        }
+
+        buf.resize( start );
+    }
+
+    append( buf, (uint32_t)RAW );
+    append( buf, rawBytes );
+    for ( int val:plane )
+        append( buf, (int32_t)val );
+
+    return RAW;
+}
+
+uint32_t TrajectoryWriter::mf_writeChanges( string& buf, vector<int>& previous, const vector<int>& sites, const vector<int>& values, bool keyframe )
+{
+    size_t start = buf.size();
+    uint64_t rawBytes = previous.size()*sizeof( int32_t );
+
+    append( buf, (uint32_t)SPARSE );
+    append( buf, (uint64_t)0 );
+    append( buf, (uint32_t)0 );
+
+    //Only the values that changed (a site may have changed and changed back)
+    uint32_t count = 0;
+    for ( size_t k = 0; k < sites.size(); k++ ){
+        int id = sites[ k ];
+        if ( previous[ id ] == values[ k ] )
+            continue;
+
+        previous[ id ] = values[ k ];
+        if ( !keyframe ){
+            append( buf, (int32_t)id );
+            append( buf, (int32_t)values[ k ] );
+        }
+        count++;
+    }
+
+    uint64_t bytes = sizeof( count ) + (uint64_t)count*2*sizeof( int32_t );
+    if ( !keyframe && bytes < rawBytes ){
+        memcpy( &buf[ start + sizeof( uint32_t ) ], &bytes, sizeof( bytes ) );
+        memcpy( &buf[ start + sizeof( uint32_t ) + sizeof( uint64_t ) ], &count, sizeof( count ) );
+        return SPARSE;
+    }
+
+    buf.resize( start );
+    append( buf, (uint32_t)RAW );
+    append( buf, rawBytes );
+    for ( int val:previous )
+        append( buf, (int32_t)val );
+
+    return RAW;
+}
+
+void TrajectoryWriter::flush()
+{
+    if ( m_File.is_open() )
+        m_File.flush();
+    if ( m_Index.is_open() )
+        m_Index.flush();
+}
+
+void TrajectoryWriter::close()
+{
+    if ( m_File.is_open() )
+        m_File.close();
+    if ( m_Index.is_open() )
+        m_Index.close();
+}
+
+//------------------------------------------------------------------------------------------------------------------//
+
+TrajectoryReader::TrajectoryReader():
+    m_iFileSize(0),
+    m_iEnd(0),
+    m_iX(0),
+    m_iY(0),
+    m_iCurrent(-1)
+{}
+
+TrajectoryReader::~TrajectoryReader()
+{}
+
+bool TrajectoryReader::open( const string& file )
+{
+    m_vEntries.clear();
+    m_iCurrent = -1;
+
+    m_File.open( file, ios::binary );
+    if ( !m_File.is_open() ){
+        m_sError = "Cannot open the trajectory " + file + ".";
+        return false;
+    }
+
+    char magic[ 8 ];
+    uint32_t version = 0, order = 0;
+    int32_t x = 0, y = 0;
+    m_File.read( magic, sizeof( magic ) );
+    readValue( m_File, version );
+    readValue( m_File, order );
+    readValue( m_File, x );
+    readValue( m_File, y );
+
+    if ( !m_File || memcmp( magic, TRAJECTORY_MAGIC, sizeof( magic ) ) != 0 ){
+        m_sError = file + " is not an Apothesis trajectory.";
+        return false;
+    }
+
+    if ( version != TRAJECTORY_VERSION || order != BYTE_ORDER_MARK ){
+        m_sError = "The trajectory " + file + " has version " + to_string( version ) + " or byte order that cannot be read.";
+        return false;
+    }
+
+    m_iX = x;
+    m_iY = y;
+
+    m_File.seekg( 0, ios::end );
+    m_iFileSize = m_File.tellg();
+
+    //The frames missing from the index (e.g. it was not written) are found from the trajectory
+    mf_readIndex( file + ".idx" );
+    return mf_scan();
+}
+
+bool TrajectoryReader::mf_readIndex( const string& file )
+{
+    ifstream in( file, ios::binary );
+    char magic[ 8 ];
+    uint32_t version = 0;
+    in.read( magic, sizeof( magic ) );
+    readValue( in, version );
+    if ( !in || memcmp( magic, INDEX_MAGIC, sizeof( magic ) ) != 0 || version != TRAJECTORY_VERSION )
+        return false;
+
+    Entry entry;
+    uint64_t previous = 0;
+    while ( readValue( in, entry.time ) && readValue( in, entry.offset ) && readValue( in, entry.planes ) && readValue( in, entry.rawPlanes ) ){
+        //The entries after a frame that is not in the trajectory are ignored
+        uint32_t frameMagic = 0;
+        uint64_t bytes = 0;
+        m_File.clear();
+        m_File.seekg( entry.offset );
+        if ( entry.offset < TRAJECTORY_HEADER || entry.offset < previous || !readValue( m_File, frameMagic ) || !readValue( m_File, bytes ) ||
+             frameMagic != FRAME_MAGIC || entry.offset + FRAME_HEADER + bytes > m_iFileSize )
+            break;
+
+        m_vEntries.push_back( entry );
+        previous = entry.offset + FRAME_HEADER + bytes;
+    }
+
+    return true;
+}
+
+bool TrajectoryReader::mf_scan()
+{
+    m_iEnd = TRAJECTORY_HEADER;
+    if ( !m_vEntries.empty() ){
+        uint64_t bytes = 0;
+        m_File.clear();
+        m_File.seekg( m_vEntries.back().offset + sizeof( uint32_t ) );
+        readValue( m_File, bytes );
+        m_iEnd = m_vEntries.back().offset + FRAME_HEADER + bytes;
+    }
+
+    //The frames after the end of the index (an incomplete frame at the end is ignored)
+    string buf;
+    while ( m_iEnd + FRAME_HEADER <= m_iFileSize ){
+        uint32_t frameMagic = 0;
+        uint64_t bytes = 0;
+        m_File.clear();
+        m_File.seekg( m_iEnd );
+        if ( !readValue( m_File, frameMagic ) || !readValue( m_File, bytes ) || frameMagic != FRAME_MAGIC || m_iEnd + FRAME_HEADER + bytes > m_iFileSize )
+            break;
+
+        buf.resize( bytes );
+        m_File.read( &buf[ 0 ], bytes );
+
+        //The header of the frame and the encodings of its planes
+        Entry entry{ 0.0, m_iEnd, 0, 0 };
+        size_t pos = 0;
+        bool valid = take( buf, pos, entry.time ) && take( buf, pos, entry.planes );
+        if ( valid && entry.planes & TrajectoryWriter::SPECIES ){
+            uint32_t num = 0, length = 0;
+            valid = take( buf, pos, num );
+            for ( uint32_t n = 0; valid && n < num; n++ ){
+                valid = take( buf, pos, length ) && pos + length <= buf.size();
+                pos += length;
+            }
+        }
+
+        for ( uint32_t plane:{ TrajectoryWriter::HEIGHTS, TrajectoryWriter::SPECIES } ){
+            if ( !valid || !( entry.planes & plane ) )
+                continue;
+
+            uint32_t encoding = 0;
+            uint64_t planeBytes = 0;
+            valid = take( buf, pos, encoding ) && take( buf, pos, planeBytes ) && pos + planeBytes <= buf.size();
+            pos += planeBytes;
+            if ( encoding == TrajectoryWriter::RAW )
+                entry.rawPlanes |= plane;
+        }
+
+        if ( !valid ){
+            m_sError = "The frame at " + to_string( m_iEnd ) + " of the trajectory is corrupted.";
+            return false;
+        }
+
+        m_vEntries.push_back( entry );
+        m_iEnd += FRAME_HEADER + bytes;
+    }
+
+    return true;
+}
+
+bool TrajectoryReader::read( int i, TrajectoryFrame& frame )
+{
+    if ( i < 0 || i >= m_vEntries.size() ){
+        m_sError = "There is no frame " + to_string( i ) + " in the trajectory.";
+        return false;
+    }
+
+    //The frames are decoded from the last keyframe or from the last decoded frame if it is on the way
+    int start = i;
+    while ( start > 0 && m_vEntries[ start ].rawPlanes != m_vEntries[ start ].planes )
+        start--;
+
+    if ( m_iCurrent >= start && m_iCurrent <= i )
+        start = m_iCurrent + 1;
+
+    for ( int k = start; k <= i; k++ ){
+        if ( !mf_decode( k ) ){
+            m_iCurrent = -1;
+            return false;
+        }
+        m_iCurrent = k;
+    }
+
+    frame = m_Current;
+    return true;
+}
+
+bool TrajectoryReader::mf_decode( int i )
+{
+    const Entry& entry = m_vEntries[ i ];
+    uint64_t bytes = 0;
+    m_File.clear();
+    m_File.seekg( entry.offset + sizeof( uint32_t ) );
+    readValue( m_File, bytes );
+
+    string buf( bytes, '\0' );
+    m_File.read( &buf[ 0 ], bytes );
+    if ( !m_File ){
+        m_sError = "Cannot read the frame " + to_string( i ) + " of the trajectory.";
+        return false;
+    }
+
+    size_t pos = 0;
+    take( buf, pos, m_Current.time );
+    take( buf, pos, m_Current.planes );
+
+    if ( m_Current.planes & TrajectoryWriter::SPECIES ){
+        uint32_t num = 0, length = 0;
+        take( buf, pos, num );
+        m_Current.names.resize( num );
+        for ( uint32_t n = 0; n < num; n++ ){
+            take( buf, pos, length );
+            m_Current.names[ n ].assign( buf, pos, length );
+            pos += length;
+        }
+    }
+    else
+        m_Current.names.clear();
+
+    size_t sites = (size_t)m_iX*m_iY;
+    for ( uint32_t plane:{ TrajectoryWriter::HEIGHTS, TrajectoryWriter::SPECIES } ){
+        vector<int>& values = plane == TrajectoryWriter::HEIGHTS ? m_Current.heights : m_Current.labels;
+        if ( !( m_Current.planes & plane ) ){
+            values.clear();
+            continue;
+        }
+
+        uint32_t encoding = 0;
+        uint64_t planeBytes = 0;
+        take( buf, pos, encoding );
+        take( buf, pos, planeBytes );
+        size_t end = pos + planeBytes;
+
+        if ( encoding == TrajectoryWriter::RAW ){
+            values.resize( sites );
+            for ( size_t k = 0; k < sites; k++ ){
+                int32_t val = 0;
+                take( buf, pos, val );
+                values[ k ] = val;
+            }
+        }
+        else if ( encoding == TrajectoryWriter::DELTA || encoding == TrajectoryWriter::SPARSE ){
+            //The differences are added to or the changed values are set in the same plane of the previous frame
+            if ( values.size() != sites ){
+                m_sError = "The frame " + to_string( i ) + " of the trajectory has no previous frame to decode from.";
+                return false;
+            }
+
+            if ( encoding == TrajectoryWriter::DELTA ){
+                size_t k = 0;
+                uint32_t count = 0;
+                int32_t diff = 0;
+                while ( pos < end && take( buf, pos, count ) && take( buf, pos, diff ) )
+                    for ( uint32_t n = 0; n < count && k < sites; n++, k++ )
+                        values[ k ] = (int32_t)( (uint32_t)values[ k ] + (uint32_t)diff );
+            }
+            else {
+                uint32_t count = 0;
+                int32_t id = 0, val = 0;
+                take( buf, pos, count );
+                for ( uint32_t n = 0; n < count && take( buf, pos, id ) && take( buf, pos, val ); n++ )
+                    if ( id >= 0 && id < sites )
+                        values[ id ] = val;
+            }
+        }
+        else {
+            m_sError = "The frame " + to_string( i ) + " of the trajectory has an unknown encoding.";
+            return false;
+        }
+
+        pos = end;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,222 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+namespace Utils
+{
+
+/** The binary trajectory: all the lattice snapshots of a run in one appendable file with an index file next to it
+ * (<file>.idx). The values are written in the byte order of the machine, which is marked in the header.
+ *
+ * Trajectory file:
+ *   header:  "APOTRAJ" '\0' | uint32 version | uint32 byte order mark 0x01020304 | int32 x | int32 y
+ *   frames:  uint32 "FRAM" | uint64 bytes of the rest of the frame | double time | uint32 planes (1: heights, 2: species)
+ *            | [species: uint32 number of names, and for each uint32 length + characters]
+ *            | for each plane (heights first): uint32 encoding | uint64 bytes | data
+ * Encodings of a plane of x * y int32 values (row after row):
+ *   RAW:    the values.
+ *   DELTA:  the differences from the same plane of the previous frame as runs of uint32 count + int32 difference.
+ *   SPARSE: the sites whose value changed since the previous frame as uint32 number + (int32 site, int32 value) pairs.
+ * Index file:
+ *   header:  "APOTIDX" '\0' | uint32 version
+ *   entries: double time | uint64 offset of the frame | uint32 planes | uint32 planes written RAW
+ *
+ * A frame whose planes are all RAW is a keyframe. A frame is decoded from the last keyframe before it. */
+
+/// A snapshot of the lattice
+struct TrajectoryFrame {
+    /// The time of the snapshot (s)
+    double time = 0.0;
+
+    /// The planes of the frame (TrajectoryWriter::HEIGHTS | TrajectoryWriter::SPECIES)
+    uint32_t planes = 0;
+
+    /// The heights of the sites (row after row)
+    vector<int> heights;
+
+    /// The species IDs of the sites (negative for an empty site)
+    vector<int> labels;
+
+    /// The names of the species by their ID
+    vector<string> names;
+};
+
+/** Appends the snapshots of the lattice to a trajectory file (see above). */
+class TrajectoryWriter
+{
+public:
+    /// The planes of a frame
+    enum Plane{ HEIGHTS = 1, SPECIES = 2 };
+
+    /// The encoding of a plane
+    enum Encoding{ RAW = 0, DELTA = 1, SPARSE = 2 };
+
+    TrajectoryWriter();
+    virtual ~TrajectoryWriter();
+
+    /// Opens the trajectory file for an x * y lattice. keyframes is the number of frames between two keyframes
+    /// (1: every frame is RAW). If append is true an existing trajectory is continued after removing its frames later
+    /// than time (e.g. those written after the checkpoint a run restarts from). Returns false on error (see getError).
+    bool open( const string& file, int x, int y, int keyframes, bool append = false, double time = 0.0 );
+
+    /// Appends a frame. planes tells which of heights and labels are written.
+    void writeFrame( double time, uint32_t planes, const vector<int>& heights, const vector<int>& labels, const vector<string>& names );
+
+    /// Appends a frame from the sites changed since the previous frame, which must have the same planes (otherwise the
+    /// frame is not written and getError tells why; the caller writes it whole with writeFrame instead).
+    /// heights and labels are the values of the sites (for the planes written). Only the sites whose value differs
+    /// from the previous frame are written, unless a keyframe is due or the changes take more space than the plane.
+    void writeChanges( double time, uint32_t planes, const vector<int>& sites, const vector<int>& heights, const vector<int>& labels,
+                       const vector<string>& names );
+
+    /// Writes the buffered frames in the files
+    void flush();
+
+    /// Closes the files
+    void close();
+
+    /// Returns the description of the last error
+    inline const string& getError() const { return m_sError; }
+
+protected:
+    /// Writes a plane with the encoding that takes less space (DELTA is used only if the previous plane is given).
+    /// Returns the encoding.
+    uint32_t mf_writePlane( string& buf, const vector<int>& plane, const vector<int>* previous );
+
+    /// Writes the values of the changed sites of a plane and updates the previous plane. RAW is written
+    /// (from the updated previous plane) if keyframe is true or the changes take more space. Returns the encoding.
+    uint32_t mf_writeChanges( string& buf, vector<int>& previous, const vector<int>& sites, const vector<int>& values, bool keyframe );
+
+    /// Writes the header of a frame (time, planes and names) in the buffer
+    void mf_writeHeader( string& buf, double time, uint32_t planes, const vector<string>& names );
+
+    /// Writes the frame in the buffer and its entry in the index
+    void mf_writeFrame( const string& buf, double time, uint32_t planes, uint32_t rawPlanes );
+
+    /// The trajectory file
+    ofstream m_File;
+
+    /// The index file
+    ofstream m_Index;
+
+    /// The offset of the next frame
+    uint64_t m_iOffset;
+
+    /// The number of frames between two keyframes
+    int m_iKeyframes;
+
+    /// The frames written since the last keyframe
+    int m_iSinceKeyframe;
+
+    /// The planes of the previous frame (the reference of the DELTA encoding)
+    TrajectoryFrame m_Previous;
+
+    /// True if there is a previous frame written in this run
+    bool m_bHasPrevious;
+
+    /// The encoding buffer (reused between the frames)
+    string m_sBuffer;
+
+    /// The last error
+    string m_sError;
+};
+
+/** Reads a trajectory file (see above). The frames are found from the index file, or by scanning the trajectory if
+ * the index is missing or incomplete. */
+class TrajectoryReader
+{
+public:
+    /// An entry of the index
+    struct Entry {
+        double time;
+        uint64_t offset;
+        uint32_t planes;
+        uint32_t rawPlanes;
+    };
+
+    TrajectoryReader();
+    virtual ~TrajectoryReader();
+
+    /// Opens the trajectory and reads its index. Returns false on error (see getError).
+    bool open( const string& file );
+
+    /// The dimensions of the lattice
+    inline int getX() const { return m_iX; }
+    inline int getY() const { return m_iY; }
+
+    /// The number of frames
+    inline int size() const { return m_vEntries.size(); }
+
+    /// The index of the frames
+    inline const vector<Entry>& getEntries() const { return m_vEntries; }
+
+    /// The offset after the last complete frame
+    inline uint64_t getEnd() const { return m_iEnd; }
+
+    /// Reads the frame i in frame (decoding from the last keyframe before it if needed). Reading the frames in
+    /// order decodes each frame once. Returns false on error (see getError).
+    bool read( int i, TrajectoryFrame& frame );
+
+    /// Returns the description of the last error
+    inline const string& getError() const { return m_sError; }
+
+protected:
+    /// Reads the entries of the index file. Returns false if it is missing or does not match the trajectory.
+    bool mf_readIndex( const string& file );
+
+    /// Finds the frames by reading the header of each frame
+    bool mf_scan();
+
+    /// Reads and decodes the frame i on top of m_Current
+    bool mf_decode( int i );
+
+    /// The trajectory file
+    ifstream m_File;
+
+    /// The size of the trajectory file
+    uint64_t m_iFileSize;
+
+    /// The offset after the last complete frame
+    uint64_t m_iEnd;
+
+    /// The dimensions of the lattice
+    int m_iX, m_iY;
+
+    /// The index of the frames
+    vector<Entry> m_vEntries;
+
+    /// The last decoded frame and its position (-1 if none)
+    TrajectoryFrame m_Current;
+    int m_iCurrent;
+
+    /// The last error
+    string m_sError;
+};
+
+}
+
+#endif // TRAJECTORY_H
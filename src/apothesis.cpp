@@ -36,20 +36,54 @@
 #include "diamond.h"
 
 #include "factory_process.h"
+#include "process_selector.h"
+#include "site_rates.h"
+#include "sublattice_engine.h"
+#include "thread_pool.h"
+#include "binary_stream.h"
+#include "affected_sites.h"
+#include "profiler.h"
 
 #include <numeric>
 #include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <cstdio>
 
 using namespace MicroProcesses;
 
 //using namespace Utils;
 
+bool ProcessOrder::operator()( MicroProcesses::Process* a, MicroProcesses::Process* b ) const {
+    return a->getSerial() < b->getSerial();
+}
+
 Apothesis::Apothesis(int argc, char *argv[])
     : pLattice(0),
       pReader(0),
+      m_pSelector(0),
+      m_pSiteRates(0),
+      m_pSublattice(0),
+      m_iNumRuled(0),
+      m_pTemplate(0),
+      m_iReplica(0),
+      m_bRestarted(false),
+      m_dRTotMax(0.0),
+      m_iEventsSinceResum(0),
+      m_dTimeToWriteLog(0.0),
+      m_dTimeToWriteLattice(0.0),
+      m_dMeanDHPrevStep(0.0),
+      m_dPrevTimeStep(0.0),
       m_dRTot(0.0),
       m_dProcRate(0.0),
-      m_debugMode(false)
+      m_debugMode(false),
+      m_iEvents(0),
+      m_dEventsPerSec(0.0),
+      m_iRuleCalls(0),
+      m_iRuleCallsSkipped(0),
+      m_pEventTrace(0)
 {
     m_iArgc = argc;
     m_vcArgv = argv;
@@ -57,6 +91,8 @@ Apothesis::Apothesis(int argc, char *argv[])
     pParameters = new Utils::Parameters(this);
     pProperties = new Utils::Properties(this);
     pRandomGen = new RandomGen::RandomGenerator( this );
+    pErrorHandler = new Utils::ErrorHandler( this );
+    m_pAffected = new MicroProcesses::AffectedSites();
 
     // Create input instance
     pIO = new IO(this);
@@ -66,32 +102,84 @@ Apothesis::Apothesis(int argc, char *argv[])
     m_nSpecies = 0;
 }
 
+Apothesis::Apothesis( Apothesis* parent, int replica, Utils::Parameters* parameters )
+    : pLattice(0),
+      pReader(0),
+      m_pSelector(0),
+      m_pSiteRates(0),
+      m_pSublattice(0),
+      m_iNumRuled(0),
+      m_pTemplate(parent),
+      m_iReplica(replica),
+      m_bRestarted(false),
+      m_dRTotMax(0.0),
+      m_iEventsSinceResum(0),
+      m_dTimeToWriteLog(0.0),
+      m_dTimeToWriteLattice(0.0),
+      m_dMeanDHPrevStep(0.0),
+      m_dPrevTimeStep(0.0),
+      m_dRTot(0.0),
+      m_dProcRate(0.0),
+      m_debugMode(parent->m_debugMode),
+      m_iEvents(0),
+      m_dEventsPerSec(0.0),
+      m_iRuleCalls(0),
+      m_iRuleCallsSkipped(0),
+      m_pEventTrace(0)
+{
+    m_iArgc = parent->m_iArgc;
+    m_vcArgv = parent->m_vcArgv;
+
+    //The parameters are only read
+    pParameters = parameters;
+    pProperties = new Utils::Properties(this);
+    pRandomGen = new RandomGen::RandomGenerator( this );
+    pErrorHandler = new Utils::ErrorHandler( this );
+    m_pAffected = new MicroProcesses::AffectedSites();
+
+    pIO = new IO(this);
+    pIO->setInMemory( true );
+
+    m_nSpecies = 0;
+}
+
 Apothesis::~Apothesis()
 {
+    for ( auto &p:m_processMap )
+        delete p.first;
+
     delete pIO;
     delete pReader;
     delete pLattice;
-    delete pParameters;
+    if ( !m_pTemplate )
+        delete pParameters;
     delete pErrorHandler;
     delete pRandomGen;
+    delete m_pSelector;
+    delete m_pSiteRates;
+    delete m_pSublattice;
+    delete m_pAffected;
 }
 
 void Apothesis::init()
 {
-    //Read the input file
-    pIO->readInputFile();
-
-    //Open the output file
-    if ( !pIO->outputOpen() )
-        pIO->openOutputFile("Output");
+    //The replicas of an ensemble share the parameters read by the parent
+    if ( !m_pTemplate ){
+        //Read the input file
+        pIO->readInputFile();
+
+        //Open the output file (a restarted run continues the output of the checkpointed one)
+        if ( !pIO->outputOpen() )
+            pIO->openOutputFile("Output", !pParameters->getRestartFile().empty() );
+    }
 
     m_dProcTime = pParameters->getStartTime();
 
-    // Initialize Random generator
+    // Initialize Random generator (each replica has its own stream)
     if ( pParameters->getRandGenInit() != 0.0 )
-        pRandomGen->init( pParameters->getRandGenInit() );
+        pRandomGen->init( pParameters->getRandGenInit() + m_iReplica );
     else
-        pRandomGen->init( time(nullptr) );
+        pRandomGen->init( time(nullptr) + m_iReplica );
 
     //Create the lattice after reading the parameters form the file
     if ( pParameters->getLatticeType() == "SimpleCubic" )
@@ -106,47 +194,69 @@ void Apothesis::init()
     pLattice->setX( pParameters->getLatticeXDim() );
     pLattice->setY( pParameters->getLatticeYDim() );
 
-    // Build the sites of the lattice
-    pLattice->buildSites();
-
-    //For the heights
-    if ( !pParameters->isReadHeightsFromFile() )
-        pLattice->setInitialHeight( pParameters->getLatticeHeight() );
-    else
-        //This is supported only for SimpleCubic cases
-        pLattice->readHeightsFromFile();
+    if ( pParameters->getNumSteps() > 0 ){
+        pLattice->setSteps( true );
+        pLattice->setNumSteps( pParameters->getNumSteps() );
+        pLattice->setStepHeight( pParameters->getStepHeight() );
+    }
 
-    //For the species
-    if ( !pParameters->isReadSpeciesFromFile() ) {
+    if ( m_pTemplate )
+        //The replica starts from the lattice built by the parent
+        pLattice->copyFrom( m_pTemplate->pLattice );
+    else {
+        // Build the sites of the lattice
+        pLattice->buildSites();
+
+        //For the heights
+        if ( !pParameters->isReadHeightsFromFile() )
+            pLattice->setInitialHeight( pParameters->getLatticeHeight() );
+        else
+            //This is supported only for SimpleCubic cases
+            pLattice->readHeightsFromFile();
+
+        //For the species
+        if ( !pParameters->isReadSpeciesFromFile() ) {
 //        pLattice->setLabels( pParameters->getLatticeLabels() );
 
-        // TODO: Here we must take into account the case of two or more species participating in the film growth
-        // and the user should give the per cent of each species in t=0s e.g. 0.8Ga 0.2As
-        for ( Site* s:pLattice->getSites() ){
-            s->setLabel(  pParameters->getLatticeLabels() );
-            s->setBelowLabel( pParameters->getLatticeLabels() );
+            // TODO: Here we must take into account the case of two or more species participating in the film growth
+            // and the user should give the per cent of each species in t=0s e.g. 0.8Ga 0.2As
+            int species = SpeciesRegistry::intern( pParameters->getLatticeLabels() );
+            for ( Site* s:pLattice->getSites() ){
+                s->setLabel( species );
+                s->setBelowLabel( species );
+            }
         }
-    }
-    else
-        //This is supported only for SimpleCubic cases
-        pLattice->readSpeciesFromFile();
+        else
+            //This is supported only for SimpleCubic cases
+            pLattice->readSpeciesFromFile();
+
+        //Build the lattice
+        pLattice->build();
+
+        //The steps set the height offsets of the neighbours in the index
+        pLattice->buildNeighbourIndex();
+
+        if ( pLattice->hasSteps() )
+            pLattice->buildSteps();
 
-    //Build the lattice
-    pLattice->build();
+        //From now on the coordination of the sites is updated by the processes that change the heights
+        pLattice->computeCoordination();
 
-    if ( pLattice->hasSteps() )
-        pLattice->buildSteps();
+        //Print lattice info: To be move in debug version
+        pLattice->printInfo();
 
-    //Print lattice info: To be move in debug version
-    pLattice->printInfo();
+        //pLattice->print();
 
-    //pLattice->print();
+        //Print parameters to check: To be move in debug version
+        pParameters->printInfo();
 
-    //Print parameters to check: To be move in debug version
-    pParameters->printInfo();
+        //With an ensemble or a sweep only the lattice is built here. Every replica creates its own processes on a copy of it.
+        if ( mf_hasReplicas() )
+            return;
+    }
 
-    //An empty set is used for the initialization of the processMap
-    set< Site* > emptySet;
+    //An empty class is used for the initialization of the processMap
+    Engine::SiteClass emptySet( pLattice->getSize() );
 
     //Create the processes
     for ( auto proc:pParameters->getProcessesInfo() ){
@@ -163,46 +273,24 @@ void Apothesis::init()
             for (string prod: pIO->getProducts( proc.first ) )
                 products.insert( pIO->analyzeCompound( prod ) );
 
-            // If the user does not use the keyword "all" then the process does not depend on the number of its neighs
-            if (proc.second.at( proc.second.size() - 1 ).compare("all") != 0){
-
-                Adsorption* a = new Adsorption();
-                for ( pair<string, int> s: products) {
-                    a->setAdrorbed( s.first );
-                    a->setNumSites( s.second );
-                }
-
-                a->setName( proc.first );
-                a->setLattice( pLattice );
-                a->setRandomGen( pRandomGen );
-                a->setErrorHandler( pErrorHandler );
-                a->setSysParams( pParameters ); //These are the systems and constants parameters
-                a->init( proc.second ); //These are the process per se parameters
-
-                m_processMap.insert( {a, emptySet} );
-
-            } else {
-
-                for ( int vacant = 0; vacant < pLattice->getNumFirstNeihgs(); vacant++) {
-
-                    Adsorption* a = new Adsorption();
+            Adsorption* a = new Adsorption();
+            for ( pair<string, int> s: products) {
+                a->setAdrorbed( s.first );
+                a->setNumSites( s.second );
+            }
 
-                    for ( pair<string, int> s: products) {
-                        a->setAdrorbed( s.first );
-                        a->setNumSites( s.second );
-                    }
+            // If the user uses the keyword "all" then the rate depends on the number of vacant neighbours of the site (one bin for each number)
+            if ( proc.second.back().compare("all") == 0 )
+                a->setNumBins( pLattice->getNumFirstNeihgs() );
 
-                    a->setNumVacantSites( vacant );
-                    a->setName( proc.first + " (" + to_string(vacant) + " V)" );
-                    a->setLattice( pLattice );
-                    a->setRandomGen( pRandomGen );
-                    a->setErrorHandler( pErrorHandler );
-                    a->setSysParams( pParameters ); //These are the systems and constants parameters
-                    a->init( proc.second ); //These are the process per se parameters
+            a->setName( proc.first );
+            a->setLattice( pLattice );
+            a->setRandomGen( pRandomGen );
+            a->setErrorHandler( pErrorHandler );
+            a->setSysParams( pParameters ); //These are the systems and constants parameters
+            a->init( proc.second ); //These are the process per se parameters
 
-                    m_processMap.insert( {a, emptySet} );
-                }
-            }
+            m_processMap.insert( { a, vector< Engine::SiteClass >( a->getNumBins(), emptySet ) } );
         }
         else if ( process.compare("Reaction") == 0 ){
 
@@ -246,7 +334,7 @@ void Apothesis::init()
 
             r->init( proc.second ); //These are the process per se parameters
 
-            m_processMap.insert( {r, emptySet} );
+            m_processMap.insert( { r, vector< Engine::SiteClass >( r->getNumBins(), emptySet ) } );
         }
         else if ( process.compare("Desorption") == 0 ){
 
@@ -259,48 +347,24 @@ void Apothesis::init()
                 products.insert( pIO->analyzeCompound( prod ) );
 
 
-            if (proc.second.at( proc.second.size() - 1 ).compare("all") != 0){
-
-                proc.second.push_back( to_string(1) );
-
-                Desorption* des = new Desorption();
-
-                for ( pair<string, int> s: products) {
-                    if ( s.first.compare("*") != 0 )
-                        des->setDesorbed( s.first );
-                }
-
-                des->setName( proc.first );
-                des->setLattice( pLattice );
-                des->setRandomGen( pRandomGen );
-                des->setErrorHandler( pErrorHandler );
-                des->setSysParams( pParameters ); //These are the systems and constants parameters
-                des->init( proc.second ); //These are the process per se parameters
-
-                m_processMap.insert( {des, emptySet} );
-
-            } else {
-                for ( int neighs = 0; neighs < pLattice->getNumFirstNeihgs(); neighs++) {
-
-                    Desorption* des = new Desorption();
+            Desorption* des = new Desorption();
+            for ( pair<string, int> s: products) {
+                if ( s.first.compare("*") != 0 )
+                    des->setDesorbed( s.first );
+            }
 
-                    for ( pair<string, int> s: products) {
-                        if ( s.first.compare("*") != 0 )
-                            des->setDesorbed( s.first );
-                    }
+            // If the user uses the keyword "all" then the rate depends on the number of neighbours of the site (one bin for each number)
+            if ( proc.second.back().compare("all") == 0 )
+                des->setNumBins( pLattice->getNumFirstNeihgs() );
 
-                    des->setNumNeighs( neighs );
-                    des->setAllNeighs(true);
-                    des->setName( proc.first + " (" + to_string(neighs + 1) + " N)" );
-                    des->setLattice( pLattice );
-                    des->setRandomGen( pRandomGen );
-                    des->setErrorHandler( pErrorHandler );
-                    des->setSysParams( pParameters ); //These are the systems and constants parameters
-                    des->init( proc.second ); //These are the process per se parameters
+            des->setName( proc.first );
+            des->setLattice( pLattice );
+            des->setRandomGen( pRandomGen );
+            des->setErrorHandler( pErrorHandler );
+            des->setSysParams( pParameters ); //These are the systems and constants parameters
+            des->init( proc.second ); //These are the process per se parameters
 
-                    m_processMap.insert( {des, emptySet} );
-                }
-            }
+            m_processMap.insert( { des, vector< Engine::SiteClass >( des->getNumBins(), emptySet ) } );
         }
         else if ( process.compare("Diffusion") == 0 ){
 
@@ -313,69 +377,89 @@ void Apothesis::init()
                 products.insert( pIO->analyzeCompound( prod ) );
 
 
-            if (proc.second.at( proc.second.size() - 1 ).compare("all") != 0){
-
-                proc.second.push_back( to_string(1) );
+            Diffusion* dif = new Diffusion();
+            for ( pair<string, int> s: products) {
+                if ( s.first.compare("*") != 0 )
+                    dif->setDiffused( s.first );
+            }
 
-                Diffusion* dif = new Diffusion();
-                for ( pair<string, int> s: products) {
-                    if ( s.first.compare("*") != 0 )
-                        dif->setDiffused( s.first );
-                }
+            // If the user uses the keyword "all" then the rate depends on the number of vacant neighbours of the site (one bin for each number)
+            if ( proc.second.back().compare("all") == 0 )
+                dif->setNumBins( pLattice->getNumFirstNeihgs() );
 
-                dif->setName( proc.first );
-                dif->setLattice( pLattice );
-                dif->setRandomGen( pRandomGen );
-                dif->setErrorHandler( pErrorHandler );
-                dif->setSysParams( pParameters ); //These are the systems and constants parameters
-                dif->init( proc.second ); //These are the process per se parameters
+            dif->setName( proc.first );
+            dif->setLattice( pLattice );
+            dif->setRandomGen( pRandomGen );
+            dif->setErrorHandler( pErrorHandler );
+            dif->setSysParams( pParameters ); //These are the systems and constants parameters
+            dif->init( proc.second ); //These are the process per se parameters
 
-                m_processMap.insert( {dif, emptySet} );
+            m_processMap.insert( { dif, vector< Engine::SiteClass >( dif->getNumBins(), emptySet ) } );
+        }
+    }
 
-            } else {
+    //Partition the lattice sites depending on the rules of each process. The rule is evaluated once for all the bins of the process.
+    for ( auto &p:m_processMap ){
+        for ( Site* s:pLattice->getSites() ){
+            int bin = p.first->getBin( s );
+            if ( bin >= 0 )
+                p.second[ bin ].insert( s );
+        }
+    }
 
-                for ( int neighs = 0; neighs < pLattice->getNumFirstNeihgs(); neighs++) {
+    //The end time of the simulation
+    m_dEndTime = pParameters->getEndTime();
 
-                    proc.second.pop_back();
-                    proc.second.push_back( to_string(neighs) );
+    //Create the selection engine for picking a process in each step
+    m_pSelector = mf_createSelector( pParameters->getSelection() );
+    if ( !m_pSelector ){
+        pErrorHandler->error_simple_msg( "Not supported selection: " + pParameters->getSelection() );
+        EXIT
+    }
 
-                    Diffusion* dif = new Diffusion();
+    //The ID of each process is its position in the process map. The classes of its bins follow the classes of the previous processes.
+    for ( auto &p:m_processMap ){
+        p.first->setID( m_vProcesses.size() );
+        m_vProcesses.push_back( p.first );
+        m_vFirstClass.push_back( m_vClasses.size() );
+        for ( int bin = 0; bin < p.first->getNumBins(); bin++ ){
+            m_vClasses.push_back( &p.second[ bin ] );
+            m_vClassProcess.push_back( p.first );
+            m_vClassBins.push_back( bin );
+            m_vClassRates.push_back( p.first->getRateConstant( bin ) );
+        }
+    }
 
-                    for ( pair<string, int> s: products) {
-                        if ( s.first.compare("*") != 0 )
-                            dif->setDiffused( s.first );
-                    }
+    m_pSelector->resize( m_vClasses.size() );
+    for ( int c = 0; c < m_vClasses.size(); c++ )
+        m_pSelector->update( c, m_vClassRates[ c ]*(double)m_vClasses[ c ]->size() );
 
-                    dif->setNumVacantSites( neighs );
-                    dif->setAllNeighs(true);
-                    dif->setName( proc.first + " (" + to_string(neighs) + " V)" );
-                    dif->setLattice( pLattice );
-                    dif->setRandomGen( pRandomGen );
-                    dif->setErrorHandler( pErrorHandler );
-                    dif->setSysParams( pParameters ); //These are the systems and constants parameters
-                    dif->init( proc.second ); //These are the process per se parameters
+    mf_buildDependencies();
 
-                    m_processMap.insert( {dif, emptySet} );
-                }
-            }
-        }
+    //The n-fold engine keeps the sum of the rate constants of the processes of each site
+    if ( pParameters->getEngine() == "nfold" ){
+        m_pSiteRates = new Engine::SiteRates();
+        m_pSiteRates->resize( pLattice->getSize() );
+        for ( int c = 0; c < m_vClasses.size(); c++ )
+            for ( Site* s:*m_vClasses[ c ] )
+                m_pSiteRates->add( s->getID(), c, m_vClassRates[ c ] );
     }
 
-    //Partition the lattice sites depending on the rules of each process
-    for ( auto &p:m_processMap ){
-        for ( Site* s:pLattice->getSites() ){
-            if ( p.first->rules( s ) )
-                p.second.insert( s );
+    if ( pParameters->getThreads() > 1 && !m_pTemplate ){
+        if ( pParameters->getCheckpointEvery() > 0.0 || !pParameters->getRestartFile().empty() ){
+            pErrorHandler->error_simple_msg( "Checkpoints are not supported by the parallel engine (threads larger than one)." );
+            EXIT
         }
-    }
 
-    //The end time of the simulation
-    m_dEndTime = pParameters->getEndTime();
+        mf_initSublattice();
+    }
 
     //Calculate first time the total probability (R) for apothesis to start --------------------------//
-    m_dRTot = 0.0;
-    for (pair<Process*, set< Site* > > p:m_processMap)
-        m_dRTot += p.first->getRateConstant()*(double)p.second.size();
+    m_dRTot = mf_sumRates();
+    m_dRTotMax = m_dRTot;
+
+    if ( !pParameters->getRestartFile().empty() && !m_pTemplate )
+        mf_readCheckpoint( pParameters->getRestartFile() );
 
     //Start writing in the output log
     //Write initialization info to log
@@ -386,6 +470,15 @@ void Apothesis::init()
     pIO->writeLogOutput("Temperature " + to_string( pParameters->getTemperature() ) + " K");
     pIO->writeLogOutput("Pressure " + to_string( pParameters->getPressure() ) + " P");
     pIO->writeLogOutput("Random init num " + to_string( pParameters->getRandGenInit() ) );
+    if ( m_bRestarted )
+        pIO->writeLogOutput("Restart from " + pParameters->getRestartFile() + " at time " + to_string( m_dProcTime ) + " sec");
+    pIO->writeLogOutput("Selection " + m_pSelector->getName() );
+    if ( m_pSublattice )
+        pIO->writeLogOutput("Engine sublattice " + to_string( m_pSublattice->getNumThreads() ) + " threads (" +
+                            to_string( m_pSublattice->getDomainsX() ) + " x " + to_string( m_pSublattice->getDomainsY() ) +
+                            " domains) window " + to_string( m_pSublattice->getWindow() ) + " s" );
+    else
+        pIO->writeLogOutput("Engine " + pParameters->getEngine() );
 
     string toWrite = "\n";
     toWrite = "Lattice " +  pLattice->getTypeAsString() + " ";
@@ -415,35 +508,41 @@ void Apothesis::init()
 
     string output = "Time (s)"s + '\t' + "Growth rate (ML/s)" + '\t' + "RMS (-)" + '\t' + "Micro-roughness (-)" + '\t';
 
-    for ( auto &p:m_processMap)
-        output += p.first->getName() + '\t';
+    for ( int c = 0; c < m_vClasses.size(); c++ )
+        output += mf_getClassName( c ) + '\t';
 
-    for ( auto &p:m_processMap)
-        output +=  p.first->getName() + " (class size)" + '\t';
+    for ( int c = 0; c < m_vClasses.size(); c++ )
+        output +=  mf_getClassName( c ) + " (class size)" + '\t';
 
     m_bHasGrowth = pParameters->getGrowthSpecies().size() > 0 ? true : false;
     m_bReportCoverages = pParameters->getCoverageSpecies().size() > 0 ? true : false;
 
     // If the user wants the coverages to be reported
     if ( m_bReportCoverages ){
-        unordered_map<string, double> covs = pLattice->computeCoverages( pParameters->getCoverageSpecies() );
+        vector< pair<string, double> > covs = pLattice->computeCoverages( pParameters->getCoverageSpecies() );
         for ( auto &p:covs)
             output +=  p.first + " (coverage)" + '\t';
     }
 
     pIO->writeInOutput( output );
 
-    if ( m_bHasGrowth )
-        pIO->writeLatticeHeights( m_dProcTime );
+    //The lattice snapshots are written in one trajectory file if it is given
+    if ( !pParameters->getTrajectoryFile().empty() && ( m_bHasGrowth || m_bReportCoverages ) )
+        pIO->openTrajectory( pParameters->getTrajectoryFile(), m_bRestarted, m_dProcTime );
 
-    if ( m_bReportCoverages )
-        pIO->writeLatticeSpecies( m_dProcTime  );
+    //The lattice at this time has been written by the checkpointed run
+    if ( m_bRestarted )
+        return;
+
+    pIO->writeLattice( m_dProcTime, m_bHasGrowth, m_bReportCoverages );
 }
 
 void Apothesis::exec()
 {
-    double timeToWriteLog = 0;
-    double timeToWriteLattice = 0;
+    if ( mf_hasReplicas() ){
+        mf_execReplicas();
+        return;
+    }
 
     string output ="";
 
@@ -451,98 +550,198 @@ void Apothesis::exec()
 
     // The average height for the first time
     double timeGrowth = 0;
-    double meanDHPrevStep = pProperties->getMeanDH();
-    double prevTimeStep = 0.0;
-
-    ostringstream streamObj;
-    streamObj.precision(15);
-    streamObj << m_dProcTime;
-    //output = std::to_string( m_dProcTime ) + '\t'
-    output = streamObj.str() + '\t'
-            + std::to_string( 0.0  ) + '\t'
-            + std::to_string( pProperties->getRMS() )  + '\t'
-            + std::to_string( pProperties->getMicroroughness() )  + '\t';
 
-    for ( auto &p:m_processMap)
-        output += std::to_string( p.first->getNumEventHappened() ) + '\t';
+    //The surface properties and the coverages are computed from the lattice as it is now (e.g. after a restart) and then updated by the events
+    pProperties->invalidate();
+    pLattice->invalidateSpeciesCounts();
+
+    //A restarted run continues the output and the writing times of the checkpointed one
+    if ( !m_bRestarted ){
+        m_dTimeToWriteLog = 0;
+        m_dTimeToWriteLattice = 0;
+        m_dMeanDHPrevStep = pProperties->getMeanDH();
+        m_dPrevTimeStep = 0.0;
+
+        ostringstream streamObj;
+        streamObj.precision(15);
+        streamObj << m_dProcTime;
+        //output = std::to_string( m_dProcTime ) + '\t'
+        output = streamObj.str() + '\t'
+                + std::to_string( 0.0  ) + '\t'
+                + std::to_string( pProperties->getRMS() )  + '\t'
+                + std::to_string( pProperties->getMicroroughness() )  + '\t';
+
+        for ( int c = 0; c < m_vClasses.size(); c++ )
+            output += std::to_string( m_vClassProcess[ c ]->getNumEventHappened( m_vClassBins[ c ] ) ) + '\t';
+
+        for ( int c = 0; c < m_vClasses.size(); c++ )
+            output += std::to_string( mf_getClassSize( c ) ) + '\t';
+
+        if ( m_bReportCoverages ) {
+            vector< pair<string, double> > covs = pLattice->computeCoverages( pParameters->getCoverageSpecies() );
+
+            for ( auto &p:covs)
+                output += std::to_string( p.second ) + '\t';
+        }
 
-    for ( auto &p:m_processMap)
-        output += std::to_string( p.second.size() ) + '\t';
+        pIO->writeInOutput( output );
+    }
 
-    if ( m_bReportCoverages ) {
-        unordered_map<string, double> covs = pLattice->computeCoverages( pParameters->getCoverageSpecies() );
+    auto wallStart = chrono::steady_clock::now();
 
-        for ( auto &p:covs)
-            output += std::to_string( p.second ) + '\t';
-    }
+    //Checkpoints are written between two steps. The clock is read every 1000 steps.
+    bool checkpoints = pParameters->getCheckpointEvery() > 0.0 && !m_pTemplate;
+    auto lastCheckpoint = wallStart;
+    long steps = 0;
+    long startEvents = m_iEvents;
 
-    pIO->writeInOutput( output );
+#ifdef APOTHESIS_PROFILE
+    Engine::Profiler profiler( m_vProcesses.size() );
+#endif
 
     while ( m_dProcTime <= m_dEndTime ){
-        //1. Get a random numbers
-        m_dSum = 0.0;
-        m_iRandom = pRandomGen->getDoubleRandom();
-
-        for ( auto &p:m_processMap){
-            m_dProcRate = p.first->getRateConstant()*(double)p.second.size();
-            m_dSum += m_dProcRate/m_dRTot;
+        Process* proc = 0;
+        int iClass = -1;
+        Site* s = 0;
+        PROFILE_START( lap );
+
+        if ( m_pSublattice ){
+            //1-5. One cycle: a time window in each quadrant of all the domains in parallel.
+            //Every site is active for one window per cycle, so the time advances by one window.
+            int quadrants[ 4 ] = { 0, 1, 2, 3 };
+            for ( int q = 3; q > 0; q-- )
+                swap( quadrants[ q ], quadrants[ pRandomGen->getIntRandom( 0, q ) ] );
+
+            for ( int q:quadrants )
+                m_iEvents += m_pSublattice->runWindow( q );
+
+            m_dt = m_pSublattice->getWindow();
+
+            //The sites changed by the threads are not collected
+            pProperties->invalidate();
+            pLattice->invalidateSpeciesCounts();
+            pIO->invalidateChanges();
+            PROFILE_LAP( profiler, SUBLATTICE, lap );
+        }
+        else if ( m_pSiteRates ){
+            //1-3. Pick the site and then the process on the site (n-fold engine)
+            if ( mf_selectNFold( iClass, s ) )
+                proc = m_vClassProcess[ iClass ];
+        }
+        else {
+            //1. Get a random numbers
+            m_iRandom = pRandomGen->getDoubleRandom();
 
-            //2. Pick a process according to the rates
-            if ( m_iRandom <= m_dSum ){
+            //2. Pick a process (the class of one of its bins) according to the rates
+            iClass = m_pSelector->select( m_iRandom );
 
-                // Calculate the average Height before
-                //                aveDH1 = pProperties->getMeanDH();
+            if ( iClass >= 0 ){
+                proc = m_vClassProcess[ iClass ];
+                Engine::SiteClass& procSites = *m_vClasses[ iClass ];
 
                 //Get a random number which is the ID of the site where this process can performed
-                m_iSiteNum = pRandomGen->getIntRandom(0, p.second.size() - 1 );
+                m_iSiteNum = pRandomGen->getIntRandom(0, procSites.size() - 1 );
 
                 //3. From this process pick the random site with id and perform it:
-                Site* s = *next( p.second.begin(), m_iSiteNum );
-
-                //Compute the average height before performing the process to measure the growth rate
-                timeGrowth = m_dProcTime;
-
-                p.first->perform( s );
-
-                //Count the event for this class
-                p.first->eventHappened();
+                s = procSites.at( m_iSiteNum );
+            }
+        }
 
-                // Check if an affected site must enter tob a class or not
-                for (Site* affectedSite:p.first->getAffectedSites() ){
-                    //Erase the affected site from the processes
-                    for (auto &p2:m_processMap){
-                        if ( !p2.first->isUncoAccepted() ) {
-                            //Added if it obeys the rules of this process
-                            if ( p2.first->rules( affectedSite ) ) {
-                                if (p2.second.find( affectedSite ) == p2.second.end() )
-                                    p2.second.insert( affectedSite );
+        if ( proc ){
+            PROFILE_LAP( profiler, SELECTION, lap );
+
+            //Compute the average height before performing the process to measure the growth rate
+            timeGrowth = m_dProcTime;
+
+            proc->perform( s, *m_pAffected );
+            PROFILE_PERFORM( profiler, proc->getID(), lap, m_pAffected->size() );
+            PROFILE_LAP( profiler, PERFORM, lap );
+
+            pProperties->update( *m_pAffected );
+            pLattice->updateSpeciesCounts( *m_pAffected );
+            pIO->trackChanges( *m_pAffected );
+            PROFILE_LAP( profiler, OBSERVABLES, lap );
+
+            //Count the event for this class
+            proc->eventHappened( m_vClassBins[ iClass ] );
+            m_iEvents++;
+
+            if ( m_pEventTrace )
+                *m_pEventTrace << mf_getClassName( iClass ) << '\t' << s->getID() << '\n';
+
+            // Check if an affected site must enter tob a class or not
+            // Only the processes whose rules read state that this process changes are checked
+            const vector< Process* >& dependents = m_vDependents[ proc->getID() ];
+            for (Site* affectedSite:*m_pAffected ){
+                for ( Process* p2:dependents ){
+                    //The rule gives the bin of the site, which is added to its class and erased from the classes of the other bins
+                    PROFILE_START( rule );
+                    int bin = p2->getBin( affectedSite );
+                    PROFILE_RULES( profiler, p2->getID(), rule );
+
+                    int first = m_vFirstClass[ p2->getID() ];
+                    for ( int b = 0; b < p2->getNumBins(); b++ ){
+                        int c = first + b;
+                        bool obeys = b == bin;
+                        bool changed;
+                        if ( obeys )
+                            changed = m_vClasses[ c ]->insert( affectedSite );
+                        else
+                            changed = m_vClasses[ c ]->erase( affectedSite );
+
+                        if ( changed ){
+                            mf_updateRate( c );
+
+                            if ( m_pSiteRates ){
+                                if ( obeys )
+                                    m_pSiteRates->add( affectedSite->getID(), c, m_vClassRates[ c ] );
+                                else
+                                    m_pSiteRates->remove( affectedSite->getID(), c, m_vClassRates[ c ] );
                             }
-                            else
-                                p2.second.erase( affectedSite );
                         }
                     }
                 }
 
-                //4. Re-compute the processes rates and re-compute Rtot (see ppt)
-                m_dRTot = 0.0;
-                for (pair<Process*, set< Site* > > p3:m_processMap)
-                    m_dRTot += p3.first->getRateConstant()*(double)p3.second.size();
+                m_iRuleCalls += dependents.size();
+                m_iRuleCallsSkipped += m_iNumRuled - dependents.size();
+            }
+            PROFILE_LAP( profiler, CLASS_UPDATE, lap );
+
+            //4. Rtot has been updated above for every class that changed (see ppt).
+            // Adding and removing rates of very different magnitude (e.g. 1e+15 and 0.1) leaves
+            // a rounding error of the order of the largest rate. Rtot is recomputed from scratch
+            // periodically and whenever it becomes much smaller than the largest value it had.
+            m_iEventsSinceResum++;
+            if ( m_iEventsSinceResum >= pParameters->getResumEvery() || m_dRTot < 1.0e-6*m_dRTotMax ){
+                m_dRTot = mf_sumRates();
+                m_dRTotMax = m_dRTot;
+                m_iEventsSinceResum = 0;
+            }
 
-                //5. Compute dt = -ln(ksi)/Rtot
-                m_dt = -log( pRandomGen->getDoubleRandom()  )/m_dRTot;
-//                                cout << m_dt << endl;
-                break;
+            if ( m_debugMode ){
+                double RTotFull = mf_sumRates();
+                if ( fabs( m_dRTot - RTotFull ) > 1.0e-9*RTotFull )
+                    pErrorHandler->warningSimple_msg( "Incremental Rtot " + to_string( m_dRTot ) + " differs from the full sum " +
+                                                      to_string( RTotFull ) + " at time " + to_string( m_dProcTime ) );
+
+                pProperties->check();
             }
+            PROFILE_LAP( profiler, RATE_SUM, lap );
+
+            //5. Compute dt = -ln(ksi)/Rtot
+            m_dt = -log( pRandomGen->getDoubleRandom()  )/m_dRTot;
+//                                cout << m_dt << endl;
+            PROFILE_LAP( profiler, TIME_STEP, lap );
         }
 
         //6. advance time: time += dt;
         m_dProcTime += m_dt;
 
         //Here compute the time for writing
-        timeToWriteLog += m_dt;
-        timeToWriteLattice += m_dt;
+        m_dTimeToWriteLog += m_dt;
+        m_dTimeToWriteLattice += m_dt;
 
-        if ( timeToWriteLog >= pParameters->getWriteLogTimeStep() ){
+        if ( m_dTimeToWriteLog >= pParameters->getWriteLogTimeStep() ){
 
             ostringstream streamObj;
             streamObj.precision(15);
@@ -550,62 +749,101 @@ void Apothesis::exec()
             streamObj << m_dProcTime;
 
             output = streamObj.str() + '\t'
-                    + std::to_string( (pProperties->getMeanDH() - meanDHPrevStep) / ( ((m_dProcTime - prevTimeStep) ) ) )+ '\t'
+                    + std::to_string( (pProperties->getMeanDH() - m_dMeanDHPrevStep) / ( ((m_dProcTime - m_dPrevTimeStep) ) ) )+ '\t'
                     + std::to_string( pProperties->getRMS() )  + '\t'
                     + std::to_string( pProperties->getMicroroughness() )  + '\t';
 
-//            cout << pProperties->getMeanDH()  <<  " " << meanDHPrevStep <<  " " << m_dProcTime << " " << prevTimeStep << " " <<  pProperties->getMeanDH() - meanDHPrevStep << endl;
+//            cout << pProperties->getMeanDH()  <<  " " << m_dMeanDHPrevStep <<  " " << m_dProcTime << " " << m_dPrevTimeStep << " " <<  pProperties->getMeanDH() - m_dMeanDHPrevStep << endl;
 
             //Store info to be used next time
-            meanDHPrevStep = pProperties->getMeanDH();
-            prevTimeStep = m_dProcTime;
+            m_dMeanDHPrevStep = pProperties->getMeanDH();
+            m_dPrevTimeStep = m_dProcTime;
 
-            for ( auto &p:m_processMap)
-                output += std::to_string( p.first->getNumEventHappened() ) + '\t';
+            for ( int c = 0; c < m_vClasses.size(); c++ )
+                output += std::to_string( m_vClassProcess[ c ]->getNumEventHappened( m_vClassBins[ c ] ) ) + '\t';
 
-            for ( auto &p:m_processMap)
-                output += std::to_string( p.second.size() ) + '\t';
+            for ( int c = 0; c < m_vClasses.size(); c++ )
+                output += std::to_string( mf_getClassSize( c ) ) + '\t';
 
             if ( m_bReportCoverages ) {
-                unordered_map<string, double> covs = pLattice->computeCoverages( pParameters->getCoverageSpecies() );
+                vector< pair<string, double> > covs = pLattice->computeCoverages( pParameters->getCoverageSpecies() );
 
                 for ( auto &p:covs)
                     output += std::to_string( p.second ) + '\t';
             }
 
             pIO->writeInOutput( output );
-            timeToWriteLog = 0.0;
+            m_dTimeToWriteLog = 0.0;
         }
 
-        if ( timeToWriteLattice >= pParameters->getWriteLatticeTimeStep() ) {
+        if ( m_dTimeToWriteLattice >= pParameters->getWriteLatticeTimeStep() ) {
 
-            if ( m_bHasGrowth )
-                pIO->writeLatticeHeights( m_dProcTime );
+            pIO->writeLattice( m_dProcTime, m_bHasGrowth, m_bReportCoverages );
 
-            if ( m_bReportCoverages )
-                pIO->writeLatticeSpecies( m_dProcTime  );
+            m_dTimeToWriteLattice = 0.0;
+        }
+        PROFILE_LAP( profiler, OUTPUT, lap );
 
-            timeToWriteLattice = 0.0;
+        if ( checkpoints && ++steps % 1000 == 0 &&
+             chrono::duration<double>( chrono::steady_clock::now() - lastCheckpoint ).count() >= pParameters->getCheckpointEvery() ){
+            mf_writeCheckpoint( pParameters->getCheckpointFile() );
+            lastCheckpoint = chrono::steady_clock::now();
+            PROFILE_LAP( profiler, CHECKPOINT, lap );
         }
     }
 
+    //The last checkpoint allows for extending the run
+    if ( checkpoints )
+        mf_writeCheckpoint( pParameters->getCheckpointFile() );
+
+    double wallTime = chrono::duration<double>( chrono::steady_clock::now() - wallStart ).count();
+    m_dEventsPerSec = wallTime > 0.0 ? ( m_iEvents - startEvents )/wallTime : 0.0;
+    //The replicas of an ensemble are reported by the ensemble
+    if ( !m_pTemplate ){
+        cout << "Events performed: " << m_iEvents - startEvents << " in " << wallTime << " s (" << m_dEventsPerSec << " events/s)" << endl;
+        if ( !m_pSublattice )
+            cout << "Rule calls: " << m_iRuleCalls << " performed, " << m_iRuleCallsSkipped << " skipped" << endl;
+        else {
+            double efficiency = m_pSublattice->getEfficiency();
+            cout << "Parallel efficiency: " << 100.0*efficiency << " % on " << m_pSublattice->getNumThreads() << " threads (speedup "
+                 << efficiency*m_pSublattice->getNumThreads() << ")" << endl;
+        }
+
+#ifdef APOTHESIS_PROFILE
+        vector<string> names;
+        for ( Process* p:m_vProcesses )
+            names.push_back( p->getName() );
+
+        if ( profiler.writeReport( "profile.json", names, m_iEvents - startEvents ) )
+            cout << "Profile written in profile.json" << endl;
+        else
+            pErrorHandler->warningSimple_msg( "Could not write the profile in profile.json." );
+#endif
+    }
+
+    //The last row is not repeated if the last step (e.g. the last window of the sublattice engine) ended on a log time
+    if ( m_dTimeToWriteLog == 0.0 && m_dPrevTimeStep == m_dProcTime ){
+        pIO->writeLattice( m_dProcTime, m_bHasGrowth, m_bReportCoverages );
+        return;
+    }
+
     ostringstream streamObjEnd;
     streamObjEnd.precision(15);
     streamObjEnd << m_dProcTime;
     //            output = std::to_string( m_dProcTime ) + '\t'
     output = streamObjEnd.str() + '\t'
-            + std::to_string( (pProperties->getMeanDH() - meanDHPrevStep)/ (m_dProcTime - timeToWriteLog)  ) + '\t'
+            + std::to_string( (pProperties->getMeanDH() - m_dMeanDHPrevStep)/ (m_dProcTime - m_dTimeToWriteLog)  ) + '\t'
             + std::to_string( pProperties->getRMS() )  + '\t'
             + std::to_string( pProperties->getMicroroughness() )  + '\t';
 
-    for ( auto &p:m_processMap)
-        output += std::to_string( p.first->getNumEventHappened() ) + '\t';
+    for ( int c = 0; c < m_vClasses.size(); c++ )
+        output += std::to_string( m_vClassProcess[ c ]->getNumEventHappened( m_vClassBins[ c ] ) ) + '\t';
 
-    for ( auto &p:m_processMap)
-        output += std::to_string( p.second.size() ) + '\t';
+    for ( int c = 0; c < m_vClasses.size(); c++ )
+        output += std::to_string( mf_getClassSize( c ) ) + '\t';
 
     if ( m_bReportCoverages ) {
-        unordered_map<string, double> covs = pLattice->computeCoverages( pParameters->getCoverageSpecies() );
+        vector< pair<string, double> > covs = pLattice->computeCoverages( pParameters->getCoverageSpecies() );
 
         for ( auto &p:covs)
             output += std::to_string( p.second ) + '\t';
@@ -613,12 +851,522 @@ void Apothesis::exec()
 
     pIO->writeInOutput( output );
 
-    if ( m_bHasGrowth )
-        pIO->writeLatticeHeights( m_dProcTime );
+    pIO->writeLattice( m_dProcTime, m_bHasGrowth, m_bReportCoverages );
+}
+
+void Apothesis::mf_updateRate( int iClass )
+{
+    double rate = m_vClassRates[ iClass ]*(double)m_vClasses[ iClass ]->size();
+
+    m_dRTot += rate - m_pSelector->getRate( iClass );
+    m_pSelector->update( iClass, rate );
+
+    if ( m_dRTot > m_dRTotMax )
+        m_dRTotMax = m_dRTot;
+}
+
+void Apothesis::mf_initSublattice()
+{
+    string error = Engine::SublatticeEngine::checkDomains( pLattice, pParameters->getThreads() );
+    if ( !error.empty() ){
+        pErrorHandler->error_simple_msg( error );
+        EXIT
+    }
 
-    if ( m_bReportCoverages )
-        pIO->writeLatticeSpecies( m_dProcTime  );
+    //The default window is the mean time between two events of the fastest process on a site
+    double window = pParameters->getWindow();
+    if ( window <= 0.0 ){
+        double kMax = 0.0;
+        for ( double rate:m_vClassRates )
+            kMax = max( kMax, rate );
+
+        window = kMax > 0.0 ? 1.0/kMax : m_dEndTime;
+    }
+
+    //Every thread has its own random generator seeded from the initial one
+    vector< RandomGen::RandomGenerator* > randomGens;
+    for ( int i = 0; i < pParameters->getThreads(); i++ ){
+        RandomGen::RandomGenerator* randomGen = new RandomGen::RandomGenerator( this );
+        randomGen->init( pParameters->getRandGenInit() + 1 + i );
+        randomGens.push_back( randomGen );
+    }
+
+    vector< vector<int> > dependents( m_vProcesses.size() );
+    for ( Process* p:m_vProcesses )
+        for ( Process* p2:m_vDependents[ p->getID() ] )
+            dependents[ p->getID() ].push_back( p2->getID() );
+
+    m_pSublattice = new Engine::SublatticeEngine( pLattice, m_vProcesses, m_vClasses, m_vFirstClass, m_vClassRates, dependents, randomGens, window );
+}
+
+bool Apothesis::mf_hasReplicas()
+{
+    return !m_pTemplate && ( pParameters->getEnsemble() > 1 || !pParameters->getSweep().empty() );
+}
+
+void Apothesis::mf_execReplicas()
+{
+    int replicas = pParameters->getEnsemble();
+
+    //The parameters of every point of the sweep (only this one without a sweep).
+    //The copies keep the pointers of this simulation but the replicas only read their values.
+    map< string, vector<double> > sweep = pParameters->getSweep();
+    vector< Utils::Parameters* > points( 1, pParameters );
+    vector< vector<double> > conditions( 1 );
+    for ( auto &var:sweep ){
+        vector< Utils::Parameters* > newPoints;
+        vector< vector<double> > newConditions;
+        for ( int p = 0; p < points.size(); p++ ){
+            for ( double value:var.second ){
+                Utils::Parameters* params = new Utils::Parameters( *points[ p ] );
+                if ( var.first == "temperature" )
+                    params->setTemperature( value );
+                else
+                    params->setPressure( value );
+
+                newPoints.push_back( params );
+                newConditions.push_back( conditions[ p ] );
+                newConditions.back().push_back( value );
+            }
+
+            if ( points[ p ] != pParameters )
+                delete points[ p ];
+        }
+
+        points = newPoints;
+        conditions = newConditions;
+    }
+
+    int jobs = points.size()*replicas;
+    int threads = pParameters->getEnsembleThreads();
+    if ( threads <= 0 )
+        threads = max( 1, (int)thread::hardware_concurrency() );
+    threads = min( threads, jobs );
+
+    if ( pParameters->getThreads() > 1 )
+        pErrorHandler->warningSimple_msg( "The replicas run the serial engine. The threads keyword is ignored." );
+
+    if ( pParameters->getCheckpointEvery() > 0.0 || !pParameters->getRestartFile().empty() )
+        pErrorHandler->warningSimple_msg( "The replicas do not write checkpoints or restart. The checkpoint and restart keywords are ignored." );
+
+    //Every thread takes the next replica that has not started until all have run.
+    //All the points of the sweep use the same random seeds.
+    vector< vector< vector<string> > > outputs( points.size(), vector< vector<string> >( replicas ) );
+    vector< long > events( jobs, 0 );
+    atomic<int> next( 0 );
+
+    auto wallStart = chrono::steady_clock::now();
+
+    Engine::ThreadPool pool( threads );
+    pool.run( [&]( int ){
+        for ( int i = next++; i < jobs; i = next++ ){
+            Apothesis* replica = new Apothesis( this, i % replicas, points[ i/replicas ] );
+            replica->init();
+            replica->exec();
+
+            outputs[ i/replicas ][ i % replicas ] = replica->getIOPointer()->getOutputLines();
+            events[ i ] = replica->getNumEvents();
+            delete replica;
+        }
+    } );
+
+    for ( Utils::Parameters* params:points )
+        if ( params != pParameters )
+            delete params;
+
+    double wallTime = chrono::duration<double>( chrono::steady_clock::now() - wallStart ).count();
+    m_iEvents = accumulate( events.begin(), events.end(), 0L );
+    m_dEventsPerSec = wallTime > 0.0 ? m_iEvents/wallTime : 0.0;
+    cout << "Events performed: " << m_iEvents << " in " << wallTime << " s (" << m_dEventsPerSec << " events/s)" << endl;
+    cout << "Replicas: " << points.size() << " points x " << replicas << " replicas on " << threads << " threads" << endl;
+
+    //The output of every point (averaged over the replicas of the ensemble)
+    vector< vector<string> > merged;
+    for ( auto &out:outputs )
+        merged.push_back( replicas > 1 ? mf_mergeReplicas( out ) : out[ 0 ] );
+
+    if ( sweep.empty() ){
+        for ( string& line:merged[ 0 ] )
+            pIO->writeInOutput( line );
+        return;
+    }
+
+    vector< int > header;
+    vector< string > names;
+    vector< vector<int> > columns;
+    mf_matchColumns( merged, header, names, columns );
+
+    for ( int l = 0; l < header[ 0 ]; l++ ){
+        pIO->writeInOutput( merged[ 0 ][ l ] );
+
+        if ( pIO->startsWith( merged[ 0 ][ l ], "Random init num" ) )
+            for ( auto &var:sweep )
+                pIO->writeLogOutput( "Sweep " + var.first + " " + to_string( var.second.size() ) + " points from " +
+                                     to_string( var.second.front() ) + " to " + to_string( var.second.back() ) );
+    }
+
+    //One table with the time series of all the points keyed by the values of the sweep
+    string output = "";
+    for ( auto &var:sweep )
+        output += ( var.first == "temperature" ? "Temperature (K)"s : "Pressure (Pa)"s ) + '\t';
+    for ( string& name:names )
+        output += name + '\t';
+    pIO->writeInOutput( output );
+
+    for ( int p = 0; p < merged.size(); p++ ){
+        string key = "";
+        for ( double value:conditions[ p ] )
+            key += std::to_string( value ) + '\t';
+
+        for ( int row = header[ p ] + 1; row < merged[ p ].size(); row++ ){
+            vector< string > values = pIO->split( merged[ p ][ row ], "\t" );
+
+            output = key;
+            for ( int c:columns[ p ] )
+                output += values[ c ] + '\t';
+            pIO->writeInOutput( output );
+        }
+    }
+}
+
+void Apothesis::mf_matchColumns( const vector< vector<string> >& outputs, vector<int>& header, vector<string>& names, vector< vector<int> >& columns )
+{
+    //The time series of each output starts after its header
+    header.assign( outputs.size(), -1 );
+    for ( int r = 0; r < outputs.size(); r++ )
+        for ( int l = 0; l < outputs[ r ].size() && header[ r ] < 0; l++ )
+            if ( pIO->startsWith( outputs[ r ][ l ], "Time (s)" ) )
+                header[ r ] = l;
+
+    if ( find( header.begin(), header.end(), -1 ) != header.end() ){
+        pErrorHandler->error_simple_msg( "A replica has no output." );
+        EXIT
+    }
+
+    //The columns of every output are matched to those of the first one by their name
+    //(the order of the processes and the coverages is not guaranteed to be the same)
+    names.clear();
+    columns.assign( outputs.size(), vector<int>() );
+    for ( int r = 0; r < outputs.size(); r++ ){
+        vector< string > cols = pIO->split( outputs[ r ][ header[ r ] ], "\t" );
+        if ( r == 0 )
+            names = cols;
+
+        for ( string& name:names ){
+            auto it = find( cols.begin(), cols.end(), name );
+            if ( it == cols.end() ){
+                pErrorHandler->error_simple_msg( "The column " + name + " is missing from a replica." );
+                EXIT
+            }
+            columns[ r ].push_back( it - cols.begin() );
+        }
+    }
+}
+
+vector<string> Apothesis::mf_mergeReplicas( const vector< vector<string> >& outputs )
+{
+    vector< int > header;
+    vector< string > names;
+    vector< vector<int> > columns;
+    mf_matchColumns( outputs, header, names, columns );
+
+    //The info of the run as written by the first replica
+    vector< string > merged;
+    for ( int l = 0; l < header[ 0 ]; l++ ){
+        merged.push_back( outputs[ 0 ][ l ] );
+
+        if ( pIO->startsWith( outputs[ 0 ][ l ], "Random init num" ) )
+            merged.push_back( "Ensemble " + to_string( outputs.size() ) + " replicas (random init num + 0 ... " +
+                              to_string( outputs.size() - 1 ) + ")" );
+    }
+
+    string output = "";
+    for ( string& name:names )
+        output += name + '\t' + name + " (SE)" + '\t';
+    merged.push_back( output );
+
+    //The rows are averaged up to the shortest time series
+    int rows = outputs[ 0 ].size() - header[ 0 ] - 1;
+    for ( int r = 1; r < outputs.size(); r++ )
+        rows = min( rows, (int)outputs[ r ].size() - header[ r ] - 1 );
+
+    int n = outputs.size();
+    for ( int row = 0; row < rows; row++ ){
+        vector< vector<string> > values( n );
+        for ( int r = 0; r < n; r++ )
+            values[ r ] = pIO->split( outputs[ r ][ header[ r ] + 1 + row ], "\t" );
+
+        output = "";
+        for ( int c = 0; c < names.size(); c++ ){
+            double sum = 0.0;
+            for ( int r = 0; r < n; r++ )
+                sum += stod( values[ r ][ columns[ r ][ c ] ] );
+            double mean = sum/n;
+
+            //The standard error of the mean from the sample variance
+            double var = 0.0;
+            for ( int r = 0; r < n; r++ )
+                var += pow( stod( values[ r ][ columns[ r ][ c ] ] ) - mean, 2 );
+            double se = n > 1 ? sqrt( var/( n - 1 )/n ) : 0.0;
+
+            if ( c == 0 ){
+                ostringstream streamObj;
+                streamObj.precision(15);
+                streamObj << mean << '\t' << se;
+                output += streamObj.str() + '\t';
+            }
+            else
+                output += std::to_string( mean ) + '\t' + std::to_string( se ) + '\t';
+        }
+
+        merged.push_back( output );
+    }
+
+    return merged;
+}
+
+Engine::ProcessSelector* Apothesis::mf_createSelector( string name )
+{
+    if ( name == "linear" )
+        return new Engine::LinearSelector();
+    else if ( name == "tree" )
+        return new Engine::TreeSelector();
+    else if ( name == "rejection" )
+        return new Engine::CompositionRejectionSelector( [this](){ return pRandomGen->getDoubleRandom(); } );
+
+    return 0;
+}
+
+void Apothesis::mf_writeCheckpoint( string file )
+{
+    //The output up to this point is written before the checkpoint that a restart continues from
+    pIO->flush();
+
+    //The checkpoint is written in a temporary file which replaces the previous one only when it is complete
+    string tmpFile = file + ".tmp";
+    ofstream out( tmpFile, ios::binary );
+    if ( !out.is_open() ){
+        pErrorHandler->warningSimple_msg( "Cannot open " + tmpFile + " for writing the checkpoint." );
+        return;
+    }
+
+    Utils::writeBinary( out, string( "Apothesis checkpoint" ) );
+    Utils::writeBinary( out, CHECKPOINT_VERSION );
+
+    pLattice->writeState( out );
+
+    Utils::writeBinary( out, m_dProcTime );
+    Utils::writeBinary( out, m_dTimeToWriteLog );
+    Utils::writeBinary( out, m_dTimeToWriteLattice );
+    Utils::writeBinary( out, m_dMeanDHPrevStep );
+    Utils::writeBinary( out, m_dPrevTimeStep );
+    Utils::writeBinary( out, m_dRTot );
+    Utils::writeBinary( out, m_dRTotMax );
+    Utils::writeBinary( out, m_iEventsSinceResum );
+    Utils::writeBinary( out, m_iEvents );
+    Utils::writeBinary( out, m_iRuleCalls );
+    Utils::writeBinary( out, m_iRuleCallsSkipped );
+
+    //The classes (the bins of the processes) in the order of their IDs with their sites in their order
+    Utils::writeBinary( out, (long)m_vClasses.size() );
+    for ( int c = 0; c < m_vClasses.size(); c++ ){
+        Utils::writeBinary( out, mf_getClassName( c ) );
+        m_vClassProcess[ c ]->writeState( out, m_vClassBins[ c ] );
+
+        vector<int> sites;
+        for ( Site* s:*m_vClasses[ c ] )
+            sites.push_back( s->getID() );
+        Utils::writeBinary( out, sites );
+    }
+
+    Utils::writeBinary( out, m_pSelector->getName() );
+    m_pSelector->write( out );
+
+    Utils::writeBinary( out, (char)( m_pSiteRates != 0 ) );
+    if ( m_pSiteRates )
+        m_pSiteRates->write( out );
+
+    pRandomGen->writeState( out );
+
+    out.close();
+    if ( !out || rename( tmpFile.c_str(), file.c_str() ) != 0 )
+        pErrorHandler->warningSimple_msg( "Could not write the checkpoint " + file + "." );
+}
+
+void Apothesis::mf_readCheckpoint( string file )
+{
+    ifstream in( file, ios::binary );
+
+    string header;
+    int version = 0;
+    Utils::readBinary( in, header );
+    Utils::readBinary( in, version );
+    if ( !in || header != "Apothesis checkpoint" || version != CHECKPOINT_VERSION ){
+        pErrorHandler->error_simple_msg( file + " is not a checkpoint of this version of Apothesis." );
+        EXIT
+    }
+
+    if ( !pLattice->readState( in ) ){
+        pErrorHandler->error_simple_msg( "The lattice of the checkpoint " + file + " does not match the lattice of the input." );
+        EXIT
+    }
+
+    Utils::readBinary( in, m_dProcTime );
+    Utils::readBinary( in, m_dTimeToWriteLog );
+    Utils::readBinary( in, m_dTimeToWriteLattice );
+    Utils::readBinary( in, m_dMeanDHPrevStep );
+    Utils::readBinary( in, m_dPrevTimeStep );
+    Utils::readBinary( in, m_dRTot );
+    Utils::readBinary( in, m_dRTotMax );
+    Utils::readBinary( in, m_iEventsSinceResum );
+    Utils::readBinary( in, m_iEvents );
+    Utils::readBinary( in, m_iRuleCalls );
+    Utils::readBinary( in, m_iRuleCallsSkipped );
+
+    //The classes are found by their names. Their IDs follow the order of creation which is normally the same.
+    long numClasses = 0;
+    Utils::readBinary( in, numClasses );
+    if ( numClasses != m_vClasses.size() ){
+        pErrorHandler->error_simple_msg( "The processes of the checkpoint " + file + " do not match the processes of the input." );
+        EXIT
+    }
+
+    vector<string> names;
+    for ( int c = 0; c < m_vClasses.size(); c++ )
+        names.push_back( mf_getClassName( c ) );
+
+    bool sameOrder = true;
+    for ( int i = 0; i < numClasses; i++ ){
+        string name;
+        Utils::readBinary( in, name );
+
+        auto it = find( names.begin(), names.end(), name );
+        if ( it == names.end() ){
+            pErrorHandler->error_simple_msg( "The process " + name + " of the checkpoint " + file + " is not in the input." );
+            EXIT
+        }
+
+        int c = it - names.begin();
+        sameOrder = sameOrder && c == i;
+        m_vClassProcess[ c ]->readState( in, m_vClassBins[ c ] );
+
+        vector<int> sites;
+        Utils::readBinary( in, sites );
+
+        Engine::SiteClass* procClass = m_vClasses[ c ];
+        procClass->clear();
+        for ( int id:sites )
+            procClass->insert( pLattice->getSite( id ) );
+    }
+
+    //The state of the selector (e.g. the order of the processes in the bins of the rejection) continues as it was if possible
+    string selection;
+    Utils::readBinary( in, selection );
+    Engine::ProcessSelector* selector = mf_createSelector( selection );
+    if ( !selector ){
+        pErrorHandler->error_simple_msg( "Not supported selection in the checkpoint " + file + ": " + selection );
+        EXIT
+    }
+    selector->read( in );
+
+    char hasSiteRates = 0;
+    Utils::readBinary( in, hasSiteRates );
+    Engine::SiteRates siteRates;
+    if ( hasSiteRates )
+        siteRates.read( in );
+
+    pRandomGen->readState( in );
+
+    if ( !in ){
+        pErrorHandler->error_simple_msg( "The checkpoint " + file + " is incomplete." );
+        EXIT
+    }
+
+    bool exact = sameOrder && selection == m_pSelector->getName() && ( hasSiteRates != 0 ) == ( m_pSiteRates != 0 );
+    if ( exact ){
+        delete m_pSelector;
+        m_pSelector = selector;
+
+        if ( m_pSiteRates )
+            *m_pSiteRates = siteRates;
+    }
+    else {
+        delete selector;
+        pErrorHandler->warningSimple_msg( "The selection, the engine or the order of the processes differ from the checkpoint. "
+                                          "The run continues from the same state but not with the same random sequence." );
+
+        for ( int c = 0; c < m_vClasses.size(); c++ )
+            m_pSelector->update( c, m_vClassRates[ c ]*(double)m_vClasses[ c ]->size() );
+
+        if ( m_pSiteRates ){
+            m_pSiteRates->resize( pLattice->getSize() );
+            for ( int c = 0; c < m_vClasses.size(); c++ )
+                for ( Site* s:*m_vClasses[ c ] )
+                    m_pSiteRates->add( s->getID(), c, m_vClassRates[ c ] );
+        }
+
+        m_dRTot = mf_sumRates();
+        m_dRTotMax = m_dRTot;
+        m_iEventsSinceResum = 0;
+    }
+
+    m_bRestarted = true;
+}
+
+int Apothesis::mf_getClassSize( int iClass )
+{
+    if ( m_pSublattice )
+        return m_pSublattice->getClassSize( iClass );
+
+    return m_vClasses[ iClass ]->size();
+}
+
+string Apothesis::mf_getClassName( int iClass )
+{
+    return m_vClassProcess[ iClass ]->getName() + m_vClassProcess[ iClass ]->getBinName( m_vClassBins[ iClass ] );
+}
+
+bool Apothesis::mf_selectNFold( int& iClass, Site*& s )
+{
+    int iSite = m_pSiteRates->select( pRandomGen->getDoubleRandom() );
+    if ( iSite < 0 )
+        return false;
+
+    s = pLattice->getSite( iSite );
+    iClass = m_pSiteRates->selectClass( iSite, pRandomGen->getDoubleRandom() );
+
+    return iClass >= 0;
+}
+
+void Apothesis::mf_buildDependencies()
+{
+    m_iNumRuled = 0;
+    m_vDependents.assign( m_vProcesses.size(), vector< Process* >() );
+
+    for ( Process* p:m_vProcesses ){
+        for ( Process* p2:m_vProcesses ){
+            if ( !p2->isUncoAccepted() && p->mayChangeRuleOf( p2 ) )
+                m_vDependents[ p->getID() ].push_back( p2 );
+        }
+    }
+
+    for ( auto &p:m_processMap )
+        if ( !p.first->isUncoAccepted() )
+            m_iNumRuled++;
+
+    if ( m_debugMode ){
+        for ( Process* p:m_vProcesses )
+            cout << p->getName() << ": " << m_vDependents[ p->getID() ].size() << " of " << m_iNumRuled << " rules re-evaluated" << endl;
+    }
+}
+
+double Apothesis::mf_sumRates()
+{
+    double sum = 0.0;
+    for ( int c = 0; c < m_vClasses.size(); c++ )
+        sum += m_vClassRates[ c ]*(double)m_vClasses[ c ]->size();
 
+    return sum;
 }
 
 void Apothesis::logSuccessfulRead(bool read, string parameter)
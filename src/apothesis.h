@@ -26,25 +26,40 @@
 #include <set>
 #include <valarray>
 
+#include "engine/site_class.h"
+
 #define EXIT { printf("Apothesis terminated. \n"); exit( EXIT_FAILURE ); }
 
+/// The version of the format of the checkpoint files
+#define CHECKPOINT_VERSION 3
+
 using namespace std;
 
 /** The basic class of the kinetic monte carlo code. */
 
 namespace Utils{ class ErrorHandler; class Parameters; class Properties; }
 namespace SurfaceTiles{ class Site; }
-namespace MicroProcesses { class Process; class Adsorption; class Desorption; class Diffusion; class SurfaceReaction; }
+namespace MicroProcesses { class Process; class Adsorption; class Desorption; class Diffusion; class SurfaceReaction; class AffectedSites; }
 namespace RandomGen { class RandomGenerator; }
+namespace Engine { class ProcessSelector; class SiteRates; class SublatticeEngine; }
 
 class Lattice;
 class IO;
 class Reader;
 
+/// Orders the processes by their creation so that the order (and the trajectory) does not depend on their addresses
+struct ProcessOrder {
+    bool operator()( MicroProcesses::Process* a, MicroProcesses::Process* b ) const;
+};
+
 class Apothesis
 {
 public:
     Apothesis( int argc, char* argv[] );
+
+    /// Constructor of a replica of an ensemble or a point of a sweep. The replica reads the given parameters (owned by the parent),
+    /// copies the lattice of the parent and keeps its output in memory. Its random generator is initialized with the seed plus the replica index.
+    Apothesis( Apothesis* parent, int replica, Utils::Parameters* parameters );
     virtual ~Apothesis();
 
     /// Pointers to the classes that will share the common space i.e. the "pointer"
@@ -91,9 +106,104 @@ public:
     /// Return number of species
     int getNumSpecies();
 
+    /// Returns the processes created by init
+    inline const vector< MicroProcesses::Process* >& getProcesses(){ return m_vProcesses; }
+
+    /// Returns the number of events performed by exec
+    inline long getNumEvents(){ return m_iEvents; }
+
+    /// Returns the events performed per second of wall time by exec
+    inline double getEventsPerSecond(){ return m_dEventsPerSec; }
+
+    /// Writes the process and the site of every event performed by the serial engines in trace (null: no trace).
+    /// Used by the regression tests.
+    inline void setEventTrace( ostream* trace ){ m_pEventTrace = trace; }
+
 private:
-    /// The process map which holds all the processes and the sites that each can be performed.
-    map< MicroProcesses::Process*, set< SurfaceTiles::Site* > > m_processMap;
+    /// The process map which holds all the processes and the sites that each can be performed in each bin of its rate table
+    /// (in the order the processes were created).
+    map< MicroProcesses::Process*, vector< Engine::SiteClass >, ProcessOrder > m_processMap;
+
+    /// The processes indexed by their ID (the order of m_processMap)
+    vector< MicroProcesses::Process* > m_vProcesses;
+
+    /// Picks the process to be performed according to the partial rates (selected with the "selection" keyword)
+    Engine::ProcessSelector* m_pSelector;
+
+    /// The classes of the bins of the processes indexed by their class ID (the processes in the order of their IDs and the bins of each in order).
+    /// The selectors pick a class.
+    vector< Engine::SiteClass* > m_vClasses;
+
+    /// The process, the bin and the rate constant of each class
+    vector< MicroProcesses::Process* > m_vClassProcess;
+    vector< int > m_vClassBins;
+    vector< double > m_vClassRates;
+
+    /// The ID of the class of the first bin of each process (indexed by the process ID)
+    vector< int > m_vFirstClass;
+
+    /// Returns the name of a class in the output: the name of its process and of its bin
+    string mf_getClassName( int iClass );
+
+    /// The total rate and the classes of each site for the n-fold engine ("engine: nfold") - null for the class engine
+    Engine::SiteRates* m_pSiteRates;
+
+    /// Picks the site and then the class (the process and its bin) on the site where the next event happens (n-fold engine).
+    /// Returns false if no process can be performed.
+    bool mf_selectNFold( int& iClass, SurfaceTiles::Site*& s );
+
+    /// The synchronous sublattice parallel engine ("threads" keyword larger than one) - null for the serial engines
+    Engine::SublatticeEngine* m_pSublattice;
+
+    /// Creates the parallel engine
+    void mf_initSublattice();
+
+    /// The sites affected by the last event (filled by the perform of the process and reused for every event)
+    MicroProcesses::AffectedSites* m_pAffected;
+
+    /// Returns the number of sites in a class (kept by the parallel engine when it is used)
+    int mf_getClassSize( int iClass );
+
+    /// For each process ID the processes whose rules (and so the classes of their bins) may change when it is performed.
+    /// Built from the state that the rules read and the performs change. Processes that are always possible are not included.
+    vector< vector< MicroProcesses::Process* > > m_vDependents;
+
+    /// Builds m_vDependents
+    void mf_buildDependencies();
+
+    /// The number of processes whose rules are checked (not always possible)
+    int m_iNumRuled;
+
+    /// The simulation whose parameters and lattice this replica shares - null if this is not a replica
+    Apothesis* m_pTemplate;
+
+    /// The index of this replica in the ensemble
+    int m_iReplica;
+
+    /// Creates the selector of the processes with the given name ("linear", "tree" or "rejection") - null if not supported
+    Engine::ProcessSelector* mf_createSelector( string name );
+
+    /// Writes everything needed to continue the run in a binary checkpoint file ("checkpoint" keyword)
+    void mf_writeCheckpoint( string file );
+
+    /// Continues the run from a checkpoint file ("restart" keyword). Called at the end of the initialization.
+    void mf_readCheckpoint( string file );
+
+    /// True if the run continues from a checkpoint
+    bool m_bRestarted;
+
+    /// True if this simulation runs replicas (the "ensemble" keyword with more than one replica or the "sweep" keyword)
+    bool mf_hasReplicas();
+
+    /// Runs the replicas of the ensemble for every point of the sweep on a thread pool and writes their output:
+    /// the mean and the standard error over the replicas and one table for all the points of the sweep
+    void mf_execReplicas();
+
+    /// Finds the header of the time series of every output and the position of every column of the first output in the others
+    void mf_matchColumns( const vector< vector<string> >& outputs, vector<int>& header, vector<string>& names, vector< vector<int> >& columns );
+
+    /// Returns the output of the replicas with the mean and the standard error over the replicas of every column
+    vector<string> mf_mergeReplicas( const vector< vector<string> >& outputs );
 
     /// The number of flags given by the user
     int m_iArgc;
@@ -110,6 +220,25 @@ private:
     /// Analyzes the process and returns its type: Adsorption, Desorption, Diffusion or Reaction
     string mf_analyzeProc(string);
 
+    /// Stores the new partial rate of a class after it has changed and updates Rtot by the difference
+    void mf_updateRate( int iClass );
+
+    /// Recomputes Rtot from the partial rates of all the classes
+    double mf_sumRates();
+
+    /// Rtot accumulated after the last full summation (used for detecting cancellation)
+    double m_dRTotMax;
+
+    /// The number of events since Rtot was last recomputed from scratch
+    long m_iEventsSinceResum;
+
+    /// The time since the log and the lattice were last written and the mean height and time at the last log
+    /// (members so that they can be stored in the checkpoints)
+    double m_dTimeToWriteLog;
+    double m_dTimeToWriteLattice;
+    double m_dMeanDHPrevStep;
+    double m_dPrevTimeStep;
+
     double m_dRTot;
     double m_dEndTime;
     double m_dProcTime;
@@ -120,6 +249,21 @@ private:
     int m_iSiteNum;
     bool m_bReportCoverages;
     bool m_bHasGrowth;
+
+    /// The number of events performed
+    long m_iEvents;
+
+    /// The events performed per second of wall time
+    double m_dEventsPerSec;
+
+    /// The number of rule evaluations for the affected sites
+    long m_iRuleCalls;
+
+    /// The number of rule evaluations skipped because the event could not change the result
+    long m_iRuleCallsSkipped;
+
+    /// The trace of the events (null if they are not traced)
+    ostream* m_pEventTrace;
 };
 
 #endif // KMC_H
@@ -0,0 +1,74 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#include "cell_class.h"
+#include "site.h"
+
+using namespace SurfaceTiles;
+
+namespace Engine
+{
+
+CellClass::CellClass( const vector<int>* cellOf, int numCells ):
+    m_pCellOf( cellOf ),
+    m_vCells( numCells )
+{
+    if ( cellOf )
+        m_vSlot.assign( cellOf->size(), -1 );
+}
+
+CellClass::~CellClass(){}
+
+bool CellClass::insert( Site* s )
+{
+    int id = s->getID();
+    if ( m_vSlot[ id ] >= 0 )
+        return false;
+
+    vector<Site*>& cell = m_vCells[ (*m_pCellOf)[ id ] ];
+    m_vSlot[ id ] = cell.size();
+    cell.push_back( s );
+    return true;
+}
+
+bool CellClass::erase( Site* s )
+{
+    int id = s->getID();
+    int slot = m_vSlot[ id ];
+    if ( slot < 0 )
+        return false;
+
+    vector<Site*>& cell = m_vCells[ (*m_pCellOf)[ id ] ];
+    Site* last = cell.back();
+    cell[ slot ] = last;
+    m_vSlot[ last->getID() ] = slot;
+    cell.pop_back();
+    m_vSlot[ id ] = -1;
+    return true;
+}
+
+int CellClass::size() const
+{
+    int n = 0;
+    for ( const vector<Site*>& cell:m_vCells )
+        n += cell.size();
+
+    return n;
+}
+
+}
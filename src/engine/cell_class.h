@@ -0,0 +1,72 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#ifndef CELL_CLASS_H
+#define CELL_CLASS_H
+
+#include <vector>
+
+using namespace std;
+
+namespace SurfaceTiles { class Site; }
+
+namespace Engine
+{
+
+/** The class of a process split in cells i.e. disjoint groups of sites. Each cell keeps its own
+ * dense vector of sites so that the sites of a cell can be picked uniformly while other cells are
+ * changed at the same time by other threads. The slot index is shared and addressed by the site ID,
+ * which is safe since every site belongs to a single cell. */
+class CellClass
+{
+public:
+    /// Constructor. cellOf holds the cell of each site ID (it must outlive the class).
+    CellClass( const vector<int>* cellOf = 0, int numCells = 0 );
+
+    /// Destructor
+    virtual ~CellClass();
+
+    /// Inserts the site in its cell. Returns false if it was already in the class.
+    bool insert( SurfaceTiles::Site* s );
+
+    /// Erases the site from its cell. Returns false if it was not in the class.
+    bool erase( SurfaceTiles::Site* s );
+
+    /// Returns the number of sites of cell c in the class.
+    inline int size( int c ) const { return m_vCells[ c ].size(); }
+
+    /// Returns the number of sites in the class (all the cells).
+    int size() const;
+
+    /// Returns the i-th site of cell c.
+    inline SurfaceTiles::Site* at( int c, int i ) const { return m_vCells[ c ][ i ]; }
+
+private:
+    /// The cell of each site
+    const vector<int>* m_pCellOf;
+
+    /// The sites of each cell
+    vector< vector<SurfaceTiles::Site*> > m_vCells;
+
+    /// The position of each site in the vector of its cell (-1 if the site is not in the class).
+    vector<int> m_vSlot;
+};
+
+}
+
+#endif // CELL_CLASS_H
@@ -0,0 +1,263 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "process_selector.h"
+#include "binary_stream.h"
+
+#include <cmath>
+
+namespace Engine
+{
+
+void ProcessSelector::write( ostream& out )
+{
+    //The linear and the tree selectors depend only on the partial rates
+    vector<double> rates( size() );
+    for ( int id = 0; id < rates.size(); id++ )
+        rates[ id ] = getRate( id );
+
+    Utils::writeBinary( out, rates );
+}
+
+void ProcessSelector::read( istream& in )
+{
+    vector<double> rates;
+    Utils::readBinary( in, rates );
+
+    resize( rates.size() );
+    for ( int id = 0; id < rates.size(); id++ )
+        update( id, rates[ id ] );
+}
+
+LinearSelector::LinearSelector():m_dTotal(0.0), m_bChanged(false){}
+
+LinearSelector::~LinearSelector(){}
+
+void LinearSelector::resize( int n )
+{
+    m_vRates.assign( n, 0.0 );
+    m_dTotal = 0.0;
+    m_bChanged = false;
+}
+
+void LinearSelector::update( int id, double rate )
+{
+    m_vRates[ id ] = rate;
+    m_bChanged = true;
+}
+
+double LinearSelector::getTotal()
+{
+    if ( m_bChanged ){
+        m_dTotal = 0.0;
+        for ( double rate:m_vRates )
+            m_dTotal += rate;
+
+        m_bChanged = false;
+    }
+
+    return m_dTotal;
+}
+
+int LinearSelector::select( double random )
+{
+    double total = getTotal();
+    double sum = 0.0;
+
+    for ( int id = 0; id < m_vRates.size(); id++ ){
+        sum += m_vRates[ id ]/total;
+        if ( random <= sum )
+            return id;
+    }
+
+    return -1;
+}
+
+TreeSelector::TreeSelector(){}
+
+TreeSelector::~TreeSelector(){}
+
+void TreeSelector::resize( int n ) { m_tree.resize( n ); }
+
+void TreeSelector::update( int id, double rate ) { m_tree.update( id, rate ); }
+
+int TreeSelector::select( double random )
+{
+    return m_tree.find( random*m_tree.getTotal() );
+}
+
+CompositionRejectionSelector::CompositionRejectionSelector( function<double()> random ):
+    m_random( random ),
+    m_iMinExp(0),
+    m_iActive(0)
+{}
+
+CompositionRejectionSelector::~CompositionRejectionSelector(){}
+
+void CompositionRejectionSelector::resize( int n )
+{
+    m_vRates.assign( n, 0.0 );
+    m_vExp.assign( n, 0 );
+    m_vPos.assign( n, -1 );
+    m_vBins.clear();
+    m_iMinExp = 0;
+    m_iActive = 0;
+}
+
+CompositionRejectionSelector::Bin& CompositionRejectionSelector::mf_getBin( int e )
+{
+    if ( m_vBins.empty() ){
+        m_iMinExp = e;
+        m_vBins.resize( 1 );
+    }
+    else if ( e < m_iMinExp ){
+        m_vBins.insert( m_vBins.begin(), m_iMinExp - e, Bin() );
+        m_iMinExp = e;
+    }
+    else if ( e - m_iMinExp >= (int)m_vBins.size() )
+        m_vBins.resize( e - m_iMinExp + 1 );
+
+    return m_vBins[ e - m_iMinExp ];
+}
+
+void CompositionRejectionSelector::mf_removeFromBin( int id )
+{
+    Bin& bin = m_vBins[ m_vExp[ id ] - m_iMinExp ];
+    int pos = m_vPos[ id ];
+    int last = bin.ids.back();
+
+    bin.ids[ pos ] = last;
+    m_vPos[ last ] = pos;
+    bin.ids.pop_back();
+    m_vPos[ id ] = -1;
+
+    // An empty bin is reset so that no rounding error is carried over
+    if ( bin.ids.empty() )
+        bin.total = 0.0;
+    else
+        bin.total -= m_vRates[ id ];
+
+    m_iActive--;
+}
+
+void CompositionRejectionSelector::update( int id, double rate )
+{
+    int e = 0;
+    if ( rate > 0.0 )
+        frexp( rate, &e );
+
+    if ( m_vPos[ id ] >= 0 && ( rate <= 0.0 || e != m_vExp[ id ] ) )
+        mf_removeFromBin( id );
+
+    if ( rate > 0.0 ){
+        Bin& bin = mf_getBin( e );
+
+        if ( m_vPos[ id ] < 0 ){
+            m_vExp[ id ] = e;
+            m_vPos[ id ] = bin.ids.size();
+            bin.ids.push_back( id );
+            bin.total += rate;
+            m_iActive++;
+        }
+        else
+            bin.total += rate - m_vRates[ id ];
+    }
+
+    m_vRates[ id ] = rate;
+}
+
+double CompositionRejectionSelector::getTotal()
+{
+    double total = 0.0;
+    for ( Bin& bin:m_vBins )
+        total += bin.total;
+
+    return total;
+}
+
+void CompositionRejectionSelector::write( ostream& out )
+{
+    //The order of the processes in the bins and the sums of the bins depend on the order of the updates
+    Utils::writeBinary( out, m_vRates );
+    Utils::writeBinary( out, m_vExp );
+    Utils::writeBinary( out, m_vPos );
+    Utils::writeBinary( out, m_iMinExp );
+    Utils::writeBinary( out, m_iActive );
+    Utils::writeBinary( out, (long)m_vBins.size() );
+    for ( Bin& bin:m_vBins ){
+        Utils::writeBinary( out, bin.ids );
+        Utils::writeBinary( out, bin.total );
+    }
+}
+
+void CompositionRejectionSelector::read( istream& in )
+{
+    Utils::readBinary( in, m_vRates );
+    Utils::readBinary( in, m_vExp );
+    Utils::readBinary( in, m_vPos );
+    Utils::readBinary( in, m_iMinExp );
+    Utils::readBinary( in, m_iActive );
+
+    long bins = 0;
+    Utils::readBinary( in, bins );
+    m_vBins.assign( bins, Bin() );
+    for ( Bin& bin:m_vBins ){
+        Utils::readBinary( in, bin.ids );
+        Utils::readBinary( in, bin.total );
+    }
+}
+
+int CompositionRejectionSelector::select( double random )
+{
+    if ( m_iActive == 0 )
+        return -1;
+
+    // Composition: the bins with the largest rates are scanned first
+    double target = random*getTotal();
+    int b = m_vBins.size() - 1;
+    int last = -1;
+    for ( ; b >= 0; b-- ){
+        if ( m_vBins[ b ].ids.empty() )
+            continue;
+
+        last = b;
+        if ( target < m_vBins[ b ].total )
+            break;
+
+        target -= m_vBins[ b ].total;
+    }
+
+    // Rounding may leave the target just above the sum of all bins
+    if ( b < 0 )
+        b = last;
+
+    // Rejection
+    Bin& bin = m_vBins[ b ];
+    double upper = ldexp( 1.0, b + m_iMinExp );
+    int n = bin.ids.size();
+    while ( true ){
+        int i = (int)( m_random()*n );
+        if ( i >= n )
+            i = n - 1;
+
+        int id = bin.ids[ i ];
+        if ( m_random()*upper < m_vRates[ id ] )
+            return id;
+    }
+}
+
+}
@@ -0,0 +1,185 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef PROCESS_SELECTOR_H
+#define PROCESS_SELECTOR_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <iostream>
+
+#include "sum_tree.h"
+
+using namespace std;
+
+namespace Engine
+{
+
+/** The pure virtual class for picking the process to be performed in each KMC step.
+ * Every process is identified by its ID (0 ... N-1) and the selector holds its partial rate
+ * i.e. rate constant x number of sites in its class. */
+class ProcessSelector
+{
+public:
+    /// Constructor
+    ProcessSelector(){}
+
+    /// Destructor
+    virtual ~ProcessSelector(){}
+
+    /// Allocates n processes with zero partial rates.
+    virtual void resize( int n ) = 0;
+
+    /// Returns the number of processes.
+    virtual int size() = 0;
+
+    /// Sets the partial rate of process id.
+    virtual void update( int id, double rate ) = 0;
+
+    /// Returns the partial rate of process id.
+    virtual double getRate( int id ) = 0;
+
+    /// Returns the sum of the partial rates.
+    virtual double getTotal() = 0;
+
+    /// Given a random number in [0, 1) returns the id of the process to be performed or -1 if none.
+    virtual int select( double random ) = 0;
+
+    /// Returns the name of the selector as used in the input file.
+    virtual string getName() = 0;
+
+    /// Writes the state of the selector (for the checkpoints). By default the partial rates.
+    virtual void write( ostream& out );
+
+    /// Reads the state written by write.
+    virtual void read( istream& in );
+};
+
+/** The original selection of Apothesis. The partial rates are scanned in the order of the ids and
+ * the first process for which the cumulative probability exceeds the random number is picked - O(N).*/
+class LinearSelector: public ProcessSelector
+{
+public:
+    LinearSelector();
+    ~LinearSelector() override;
+
+    void resize( int n ) override;
+    int size() override { return m_vRates.size(); }
+    void update( int id, double rate ) override;
+    double getRate( int id ) override { return m_vRates[ id ]; }
+    double getTotal() override;
+    int select( double random ) override;
+    string getName() override { return "linear"; }
+
+private:
+    /// The partial rate of each process
+    vector<double> m_vRates;
+
+    /// The sum of the partial rates
+    double m_dTotal;
+
+    /// True if a rate has changed after the last summation
+    bool m_bChanged;
+};
+
+/** Selection through a binary sum tree over the partial rates - O(log N) per update and per selection.
+ * For the same random number it picks the same process as the LinearSelector up to the rounding: the linear scan
+ * compares the random number with the sums of rate/total, the tree compares random*total with the sums of the rates,
+ * so a random number within rounding of a boundary between two processes may pick the other one. */
+class TreeSelector: public ProcessSelector
+{
+public:
+    TreeSelector();
+    ~TreeSelector() override;
+
+    void resize( int n ) override;
+    int size() override { return m_tree.size(); }
+    void update( int id, double rate ) override;
+    double getRate( int id ) override { return m_tree.get( id ); }
+    double getTotal() override { return m_tree.getTotal(); }
+    int select( double random ) override;
+    string getName() override { return "tree"; }
+
+private:
+    /// The tree holding the partial rates
+    SumTree m_tree;
+};
+
+/** Composition-rejection selection (SSA-CR). The processes are grouped in bins so that every
+ * partial rate in bin e lies in [2^(e-1), 2^e). A bin is picked by scanning the bin sums and a process
+ * of the bin is picked by rejection: a process of the bin is drawn uniformly and accepted
+ * with probability rate/2^e (>= 1/2). The cost depends on the number of bins, i.e. on the spread of the
+ * rates (about 60 bins for 1e-2 ... 1e+15), and not on the number of processes.
+ * The rejection step draws its own random numbers from the function given in the constructor. */
+class CompositionRejectionSelector: public ProcessSelector
+{
+public:
+    CompositionRejectionSelector( function<double()> random );
+    ~CompositionRejectionSelector() override;
+
+    void resize( int n ) override;
+    int size() override { return m_vRates.size(); }
+    void update( int id, double rate ) override;
+    double getRate( int id ) override { return m_vRates[ id ]; }
+    double getTotal() override;
+    int select( double random ) override;
+    string getName() override { return "rejection"; }
+    void write( ostream& out ) override;
+    void read( istream& in ) override;
+
+private:
+    /// A group of processes with partial rates within a factor of two
+    struct Bin {
+        /// The ids of the processes in the bin
+        vector<int> ids;
+
+        /// The sum of their partial rates
+        double total = 0.0;
+    };
+
+    /// Removes process id from its bin
+    void mf_removeFromBin( int id );
+
+    /// Returns the bin for exponent e, extending the range of bins if needed
+    Bin& mf_getBin( int e );
+
+    /// Draws the random numbers for the rejection step
+    function<double()> m_random;
+
+    /// The partial rate of each process
+    vector<double> m_vRates;
+
+    /// The exponent of the bin of each process (only valid if m_vPos >= 0)
+    vector<int> m_vExp;
+
+    /// The position of each process in its bin - -1 if it is not in any bin (zero rate)
+    vector<int> m_vPos;
+
+    /// The bins for exponents m_iMinExp ... m_iMinExp + m_vBins.size() - 1
+    vector<Bin> m_vBins;
+
+    /// The exponent of m_vBins[ 0 ]
+    int m_iMinExp;
+
+    /// The number of processes with non zero rate
+    int m_iActive;
+};
+
+}
+
+#endif // PROCESS_SELECTOR_H
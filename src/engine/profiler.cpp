@@ -0,0 +1,107 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#include "profiler.h"
+
+#ifdef APOTHESIS_PROFILE
+
+#include <fstream>
+
+namespace Engine
+{
+
+Profiler::Profiler( int processes ):
+    m_vRules( processes ),
+    m_vPerform( processes ),
+    m_vFanout( processes, 0 ),
+    m_vMaxFanout( processes, 0 ),
+    m_iStartTicks( now() ),
+    m_StartClock( chrono::steady_clock::now() )
+{}
+
+Profiler::~Profiler()
+{}
+
+const char* Profiler::mf_phaseName( int phase )
+{
+    static const char* names[ NUM_PHASES ] = { "selection", "perform", "observables", "class_update", "rate_sum", "time_step",
+                                                 "output", "checkpoint", "sublattice" };
+    return names[ phase ];
+}
+
+bool Profiler::writeReport( const string& file, const vector<string>& names, long events )
+{
+    //The seconds per timestamp from the clock over the whole run
+    double wall = chrono::duration<double>( chrono::steady_clock::now() - m_StartClock ).count();
+    uint64_t ticks = now() - m_iStartTicks;
+    double secPerTick = ticks > 0 ? wall/ticks : 0.0;
+
+    ofstream out( file );
+    if ( !out.is_open() )
+        return false;
+
+    auto escape = []( const string& str ){
+        string escaped;
+        for ( char c:str ){
+            if ( c == '"' || c == '\\' )
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    };
+
+    auto counter = [&]( const Counter& c ){
+        double sec = c.ticks*secPerTick;
+        return "{ \"calls\": " + to_string( c.calls ) + ", \"time_s\": " + to_string( sec ) +
+               ", \"ns_per_call\": " + to_string( c.calls > 0 ? 1.0e9*sec/c.calls : 0.0 ) + " }";
+    };
+
+    out << "{\n";
+    out << "  \"events\": " << events << ",\n";
+    out << "  \"wall_time_s\": " << to_string( wall ) << ",\n";
+#if defined( __x86_64__ ) || defined( __i386__ )
+    out << "  \"timer\": \"tsc\",\n";
+#else
+    out << "  \"timer\": \"steady_clock\",\n";
+#endif
+    out << "  \"ns_per_tick\": " << to_string( 1.0e9*secPerTick ) << ",\n";
+
+    //The rules are timed inside the class update
+    out << "  \"phases\": {\n";
+    for ( int p = 0; p < NUM_PHASES; p++ )
+        out << "    \"" << mf_phaseName( p ) << "\": " << counter( m_aPhases[ p ] ) << ( p + 1 < NUM_PHASES ? ",\n" : "\n" );
+    out << "  },\n";
+
+    out << "  \"processes\": [\n";
+    for ( int i = 0; i < m_vPerform.size(); i++ ){
+        long calls = m_vPerform[ i ].calls;
+        out << "    { \"id\": " << i << ", \"name\": \"" << escape( i < names.size() ? names[ i ] : "" ) << "\",\n";
+        out << "      \"perform\": " << counter( m_vPerform[ i ] ) << ",\n";
+        out << "      \"rules\": " << counter( m_vRules[ i ] ) << ",\n";
+        out << "      \"fanout\": { \"mean\": " << to_string( calls > 0 ? (double)m_vFanout[ i ]/calls : 0.0 ) << ", \"max\": " << m_vMaxFanout[ i ] << " } }"
+            << ( i + 1 < m_vPerform.size() ? ",\n" : "\n" );
+    }
+    out << "  ]\n";
+    out << "}\n";
+
+    return (bool)out;
+}
+
+}
+
+#endif // APOTHESIS_PROFILE
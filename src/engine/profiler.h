@@ -0,0 +1,147 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/** The profiler of the event loop. It is built only with APOTHESIS_PROFILE defined (cmake -DAPOTHESIS_PROFILE=ON):
+ * without it the PROFILE_ macros below are empty and nothing of the profiler is compiled.
+ *
+ * The loop is split in phases by laps of one timestamp: PROFILE_START( t ) takes the timestamp and
+ * PROFILE_LAP( profiler, PHASE, t ) adds the time since t to the phase and restarts t. The rules and the performs are
+ * timed per process with PROFILE_RULES and PROFILE_PERFORM. The timestamps are the time stamp counter of the CPU
+ * where it is available (a few ns) and the steady clock otherwise; they are converted to seconds in the report.
+ * The profiler is used by the thread of the event loop only (the parallel engine is timed as one phase). */
+
+#ifdef APOTHESIS_PROFILE
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+namespace Engine
+{
+
+class Profiler
+{
+public:
+    /// The phases of an event
+    enum Phase{
+        SELECTION,
+        PERFORM,
+        OBSERVABLES,
+        CLASS_UPDATE,
+        RATE_SUM,
+        TIME_STEP,
+        OUTPUT,
+        CHECKPOINT,
+        SUBLATTICE,
+        NUM_PHASES
+    };
+
+    /// Constructor. The number of processes is the number of their IDs.
+    Profiler( int processes );
+
+    virtual ~Profiler();
+
+    /// Returns the timestamp
+    static inline uint64_t now(){
+#if defined( __x86_64__ ) || defined( __i386__ )
+        return __rdtsc();
+#else
+        return chrono::duration_cast<chrono::nanoseconds>( chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+    }
+
+    /// Adds the time since t to the phase and sets t to now
+    inline void lap( Phase phase, uint64_t& t ){
+        uint64_t n = now();
+        m_aPhases[ phase ].ticks += n - t;
+        m_aPhases[ phase ].calls++;
+        t = n;
+    }
+
+    /// Adds a call of the rules of the process with the time since t
+    inline void rules( int process, uint64_t t ){
+        m_vRules[ process ].ticks += now() - t;
+        m_vRules[ process ].calls++;
+    }
+
+    /// Adds a perform of the process with the time since t and the number of the sites it affected
+    inline void perform( int process, uint64_t t, int fanout ){
+        m_vPerform[ process ].ticks += now() - t;
+        m_vPerform[ process ].calls++;
+        m_vFanout[ process ] += fanout;
+        if ( fanout > m_vMaxFanout[ process ] )
+            m_vMaxFanout[ process ] = fanout;
+    }
+
+    /// Writes the report in JSON. names are the names of the processes by their ID.
+    bool writeReport( const string& file, const vector<string>& names, long events );
+
+protected:
+    /// The time and the number of calls of a phase or a process
+    struct Counter {
+        uint64_t ticks = 0;
+        long calls = 0;
+    };
+
+    /// Returns the name of the phase in the report
+    static const char* mf_phaseName( int phase );
+
+    Counter m_aPhases[ NUM_PHASES ];
+
+    /// The rules and the performs of the processes by their ID
+    vector<Counter> m_vRules;
+    vector<Counter> m_vPerform;
+
+    /// The sum and the maximum of the sites affected by the performs of the processes by their ID
+    vector<long> m_vFanout;
+    vector<int> m_vMaxFanout;
+
+    /// The timestamp and the clock when the profiler was created (for converting the timestamps to seconds)
+    uint64_t m_iStartTicks;
+    chrono::steady_clock::time_point m_StartClock;
+};
+
+}
+
+#define PROFILE_START( t ) uint64_t t = Engine::Profiler::now()
+#define PROFILE_RESTART( t ) t = Engine::Profiler::now()
+#define PROFILE_LAP( profiler, phase, t ) ( profiler ).lap( Engine::Profiler::phase, t )
+#define PROFILE_RULES( profiler, process, t ) ( profiler ).rules( process, t )
+#define PROFILE_PERFORM( profiler, process, t, fanout ) ( profiler ).perform( process, t, fanout )
+
+#else
+
+#define PROFILE_START( t )
+#define PROFILE_RESTART( t )
+#define PROFILE_LAP( profiler, phase, t )
+#define PROFILE_RULES( profiler, process, t )
+#define PROFILE_PERFORM( profiler, process, t, fanout )
+
+#endif // APOTHESIS_PROFILE
+
+#endif // PROFILER_H
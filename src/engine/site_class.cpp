@@ -0,0 +1,75 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "site_class.h"
+#include "site.h"
+
+using namespace SurfaceTiles;
+
+namespace Engine
+{
+
+SiteClass::SiteClass( int numSites ):m_vSlot( numSites, -1 ){}
+
+SiteClass::~SiteClass(){}
+
+void SiteClass::resize( int numSites )
+{
+    m_vSites.clear();
+    m_vSlot.assign( numSites, -1 );
+}
+
+bool SiteClass::insert( Site* s )
+{
+    int& slot = m_vSlot[ s->getID() ];
+    if ( slot >= 0 )
+        return false;
+
+    slot = m_vSites.size();
+    m_vSites.push_back( s );
+    return true;
+}
+
+bool SiteClass::erase( Site* s )
+{
+    int& slot = m_vSlot[ s->getID() ];
+    if ( slot < 0 )
+        return false;
+
+    // Move the last site in the position of the erased one
+    Site* last = m_vSites.back();
+    m_vSites[ slot ] = last;
+    m_vSlot[ last->getID() ] = slot;
+    m_vSites.pop_back();
+    slot = -1;
+    return true;
+}
+
+bool SiteClass::contains( Site* s )
+{
+    return m_vSlot[ s->getID() ] >= 0;
+}
+
+void SiteClass::clear()
+{
+    for ( Site* s:m_vSites )
+        m_vSlot[ s->getID() ] = -1;
+
+    m_vSites.clear();
+}
+
+}
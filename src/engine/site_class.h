@@ -0,0 +1,78 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef SITE_CLASS_H
+#define SITE_CLASS_H
+
+#include <vector>
+
+using namespace std;
+
+namespace SurfaceTiles { class Site; }
+
+namespace Engine
+{
+
+/** The sites where a process can be performed (the class of the process).
+ * The sites are stored in a dense vector and the position of each site in the vector
+ * is stored in a slot index addressed by the ID of the site. Insert, erase, contains and
+ * picking the i-th site are O(1). Erasing moves the last site in the position of the erased one
+ * so the order of the sites is not preserved. */
+class SiteClass
+{
+public:
+    /// Constructor. The class can hold sites with IDs in [0, numSites).
+    SiteClass( int numSites = 0 );
+
+    /// Destructor
+    virtual ~SiteClass();
+
+    /// Clears the class and allows for sites with IDs in [0, numSites).
+    void resize( int numSites );
+
+    /// Inserts the site. Returns false if it was already in the class.
+    bool insert( SurfaceTiles::Site* s );
+
+    /// Erases the site. Returns false if it was not in the class.
+    bool erase( SurfaceTiles::Site* s );
+
+    /// Returns true if the site is in the class.
+    bool contains( SurfaceTiles::Site* s );
+
+    /// Removes all the sites.
+    void clear();
+
+    /// Returns the number of sites in the class.
+    inline int size() const { return m_vSites.size(); }
+
+    /// Returns the i-th site. Used for picking a site uniformly with a random i in [0, size()).
+    inline SurfaceTiles::Site* at( int i ) const { return m_vSites[ i ]; }
+
+    inline vector<SurfaceTiles::Site*>::const_iterator begin() const { return m_vSites.begin(); }
+    inline vector<SurfaceTiles::Site*>::const_iterator end() const { return m_vSites.end(); }
+
+private:
+    /// The sites of the class.
+    vector<SurfaceTiles::Site*> m_vSites;
+
+    /// The position of each site in m_vSites (-1 if the site is not in the class).
+    vector<int> m_vSlot;
+};
+
+}
+
+#endif // SITE_CLASS_H
@@ -0,0 +1,117 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#include "site_rates.h"
+#include "binary_stream.h"
+
+namespace Engine
+{
+
+SiteRates::SiteRates(){}
+
+SiteRates::~SiteRates(){}
+
+void SiteRates::resize( int n )
+{
+    m_tree.resize( n );
+    m_vClasses.assign( n, vector<int>() );
+}
+
+void SiteRates::add( int i, int c, double rate )
+{
+    if ( c >= m_vRates.size() )
+        m_vRates.resize( c + 1, 0.0 );
+    m_vRates[ c ] = rate;
+
+    m_vClasses[ i ].push_back( c );
+    m_tree.update( i, m_tree.get( i ) + rate );
+}
+
+void SiteRates::remove( int i, int c, double rate )
+{
+    //The order of the classes of a site does not matter, so the last one takes the place of the removed one
+    vector<int>& classes = m_vClasses[ i ];
+    for ( int k = 0; k < classes.size(); k++ ){
+        if ( classes[ k ] == c ){
+            classes[ k ] = classes.back();
+            classes.pop_back();
+            break;
+        }
+    }
+
+    if ( classes.empty() )
+        m_tree.update( i, 0.0 );
+    else
+        m_tree.update( i, m_tree.get( i ) - rate );
+}
+
+int SiteRates::select( double random )
+{
+    return m_tree.find( random*m_tree.getTotal() );
+}
+
+int SiteRates::selectClass( int i, double random )
+{
+    double target = random*m_tree.get( i );
+
+    //Rounding may leave the target just above the rate of the site, so the last class is kept
+    int c = -1;
+    for ( int cls:m_vClasses[ i ] ){
+        c = cls;
+        target -= m_vRates[ cls ];
+        if ( target < 0.0 )
+            break;
+    }
+
+    return c;
+}
+
+void SiteRates::write( ostream& out )
+{
+    //The rates are sums of additions and removals so they are stored as they are
+    m_tree.write( out );
+    Utils::writeBinary( out, m_vRates );
+
+    //The classes of each site in their order, which the selection of the class depends on
+    vector<int> counts, classes;
+    for ( const vector<int>& site:m_vClasses ){
+        counts.push_back( site.size() );
+        classes.insert( classes.end(), site.begin(), site.end() );
+    }
+
+    Utils::writeBinary( out, counts );
+    Utils::writeBinary( out, classes );
+}
+
+void SiteRates::read( istream& in )
+{
+    m_tree.read( in );
+    Utils::readBinary( in, m_vRates );
+
+    vector<int> counts, classes;
+    Utils::readBinary( in, counts );
+    Utils::readBinary( in, classes );
+
+    m_vClasses.assign( counts.size(), vector<int>() );
+    int k = 0;
+    for ( int i = 0; i < counts.size(); i++ )
+        for ( int n = 0; n < counts[ i ] && k < classes.size(); n++, k++ )
+            m_vClasses[ i ].push_back( classes[ k ] );
+}
+
+}
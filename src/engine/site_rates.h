@@ -0,0 +1,85 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#ifndef SITE_RATES_H
+#define SITE_RATES_H
+
+#include <vector>
+
+#include "sum_tree.h"
+
+using namespace std;
+
+namespace Engine
+{
+
+/** The total rate of each site i.e. the sum of the rate constants of the processes that can be
+ * performed on it (BKL n-fold way). The sites are the leaves of a binary sum tree indexed by their ID,
+ * so an event picks first a site in O(log N) and then one of the processes of the site.
+ * Each site keeps the classes (process and bin) it belongs to, so picking the process
+ * costs O(number of processes of the site) and not O(number of classes). */
+class SiteRates
+{
+public:
+    /// Constructor
+    SiteRates();
+
+    /// Destructor
+    virtual ~SiteRates();
+
+    /// Allocates n sites with no processes.
+    void resize( int n );
+
+    /// Adds the rate constant of the class c that site i now belongs to.
+    void add( int i, int c, double rate );
+
+    /// Removes the rate constant of the class c that site i no longer belongs to.
+    void remove( int i, int c, double rate );
+
+    /// Returns the total rate of site i.
+    inline double get( int i ){ return m_tree.get( i ); }
+
+    /// Returns the sum of the rates of all the sites.
+    inline double getTotal(){ return m_tree.getTotal(); }
+
+    /// Given a random number in [0, 1) returns the ID of the site where the next event happens or -1 if none.
+    int select( double random );
+
+    /// Given a random number in [0, 1) returns the class of site i where the next event happens or -1 if none.
+    int selectClass( int i, double random );
+
+    /// Writes the rates and the classes of the sites (for the checkpoints).
+    void write( ostream& out );
+
+    /// Reads the rates and the classes written by write.
+    void read( istream& in );
+
+private:
+    /// The rates of the sites
+    SumTree m_tree;
+
+    /// The classes of each site (in no order). A site without classes is reset to exactly zero rate.
+    vector< vector<int> > m_vClasses;
+
+    /// The rate constant of each class
+    vector<double> m_vRates;
+};
+
+}
+
+#endif // SITE_RATES_H
@@ -0,0 +1,264 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#include "sublattice_engine.h"
+
+#include <cmath>
+#include <chrono>
+
+#include "lattice.h"
+#include "site.h"
+#include "process.h"
+#include "affected_sites.h"
+#include "extLibs/random_generator.h"
+
+using namespace SurfaceTiles;
+using namespace MicroProcesses;
+
+namespace Engine
+{
+
+SublatticeEngine::SublatticeEngine( Lattice* lattice,
+                                    const vector< Process* >& processes,
+                                    const vector< SiteClass* >& classes,
+                                    const vector<int>& firstClass,
+                                    const vector<double>& rates,
+                                    const vector< vector<int> >& dependents,
+                                    const vector< RandomGen::RandomGenerator* >& randomGens,
+                                    double window ):
+    m_pLattice( lattice ),
+    m_vProcesses( processes ),
+    m_vFirstClass( firstClass ),
+    m_vRates( rates ),
+    m_vDependents( dependents ),
+    m_iThreads( randomGens.size() ),
+    m_dWindow( window ),
+    m_dBusyTime( 0.0 ),
+    m_dWallTime( 0.0 )
+{
+    mf_factorize( lattice, m_iThreads, m_iPx, m_iPy );
+
+    //The cell of each site. Site (i, j) is in row i (y) and column j (x).
+    int X = lattice->getX();
+    int Y = lattice->getY();
+    m_vCellOf.resize( lattice->getSize() );
+    for ( int i = 0; i < Y; i++ ){
+        int dy = ( i*m_iPy )/Y;
+        int y0 = ( dy*Y + m_iPy - 1 )/m_iPy;
+        int y1 = ( ( dy + 1 )*Y + m_iPy - 1 )/m_iPy;
+        int qy = ( i - y0 < ( y1 - y0 )/2 ) ? 0 : 1;
+
+        for ( int j = 0; j < X; j++ ){
+            int dx = ( j*m_iPx )/X;
+            int x0 = ( dx*X + m_iPx - 1 )/m_iPx;
+            int x1 = ( ( dx + 1 )*X + m_iPx - 1 )/m_iPx;
+            int qx = ( j - x0 < ( x1 - x0 )/2 ) ? 0 : 1;
+
+            m_vCellOf[ i*X + j ] = 4*( dy*m_iPx + dx ) + 2*qy + qx;
+        }
+    }
+
+    for ( int id = 0; id < (int)classes.size(); id++ ){
+        m_vClasses.push_back( CellClass( &m_vCellOf, 4*m_iThreads ) );
+        for ( Site* s:*classes[ id ] )
+            m_vClasses[ id ].insert( s );
+    }
+
+    for ( int id = 0; id < (int)processes.size(); id++ ){
+        m_vClassProcess.insert( m_vClassProcess.end(), processes[ id ]->getNumBins(), id );
+
+        if ( !processes[ id ]->isUncoAccepted() )
+            m_vRuled.push_back( id );
+    }
+
+    m_vDomains.resize( m_iThreads );
+    for ( int d = 0; d < m_iThreads; d++ ){
+        Domain& dom = m_vDomains[ d ];
+        dom.randomGen = randomGens[ d ];
+        dom.affected = new AffectedSites();
+        dom.events.assign( classes.size(), 0 );
+        dom.busy = 0.0;
+
+        for ( Process* p:processes ){
+            Process* copy = p->clone();
+            copy->setRandomGen( dom.randomGen );
+            dom.processes.push_back( copy );
+        }
+    }
+
+    m_pPool = new ThreadPool( m_iThreads );
+}
+
+SublatticeEngine::~SublatticeEngine()
+{
+    delete m_pPool;
+
+    for ( Domain& dom:m_vDomains ){
+        for ( Process* p:dom.processes )
+            delete p;
+
+        delete dom.randomGen;
+        delete dom.affected;
+    }
+}
+
+void SublatticeEngine::mf_factorize( Lattice* lattice, int threads, int& px, int& py )
+{
+    //The factor pair with the domains closest to squares
+    double best = -1.0;
+    for ( int f = 1; f <= threads; f++ ){
+        if ( threads % f != 0 )
+            continue;
+
+        double dx = (double)lattice->getX()/f;
+        double dy = (double)lattice->getY()/( threads/f );
+        double aspect = dx < dy ? dx/dy : dy/dx;
+        if ( aspect > best ){
+            best = aspect;
+            px = f;
+            py = threads/f;
+        }
+    }
+}
+
+string SublatticeEngine::checkDomains( Lattice* lattice, int threads )
+{
+    int px = 1, py = 1;
+    mf_factorize( lattice, threads, px, py );
+
+    if ( lattice->getX()/px < 2*MIN_QUADRANT || lattice->getY()/py < 2*MIN_QUADRANT )
+        return "The lattice is too small for " + to_string( threads ) + " threads (" + to_string( px ) + " x " + to_string( py ) +
+                " domains). Each domain must have at least " + to_string( 2*MIN_QUADRANT ) + " x " + to_string( 2*MIN_QUADRANT ) + " sites.";
+
+    return "";
+}
+
+long SublatticeEngine::runWindow( int quadrant )
+{
+    auto start = chrono::steady_clock::now();
+
+    m_pPool->run( [this, quadrant]( int d ){ mf_runCell( d, 4*d + quadrant ); } );
+
+    //Synchronization: the events are added to the original processes and the sites
+    //affected outside the active quadrants are re-evaluated
+    long events = 0;
+    for ( Domain& dom:m_vDomains ){
+        for ( int id = 0; id < (int)m_vClasses.size(); id++ ){
+            int iProc = m_vClassProcess[ id ];
+            m_vProcesses[ iProc ]->eventsHappened( id - m_vFirstClass[ iProc ], dom.events[ id ] );
+            events += dom.events[ id ];
+            dom.events[ id ] = 0;
+        }
+
+        for ( Site* s:dom.deferred )
+            mf_reevaluate( s );
+
+        dom.deferred.clear();
+        m_dBusyTime += dom.busy;
+        dom.busy = 0.0;
+    }
+
+    m_dWallTime += chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+    return events;
+}
+
+void SublatticeEngine::mf_runCell( int d, int c )
+{
+    auto start = chrono::steady_clock::now();
+
+    Domain& dom = m_vDomains[ d ];
+    int numClasses = m_vClasses.size();
+    vector<double> rates( numClasses );
+    double time = 0.0;
+
+    while ( true ){
+        double RTot = 0.0;
+        for ( int id = 0; id < numClasses; id++ ){
+            rates[ id ] = m_vRates[ id ]*m_vClasses[ id ].size( c );
+            RTot += rates[ id ];
+        }
+
+        if ( RTot <= 0.0 )
+            break;
+
+        //The event that would exceed the window is rejected
+        time += -log( dom.randomGen->getDoubleRandom() )/RTot;
+        if ( time > m_dWindow )
+            break;
+
+        double target = dom.randomGen->getDoubleRandom()*RTot;
+        int iClass = -1;
+        for ( int id = 0; id < numClasses; id++ ){
+            if ( rates[ id ] <= 0.0 )
+                continue;
+
+            iClass = id;
+            target -= rates[ id ];
+            if ( target < 0.0 )
+                break;
+        }
+
+        CellClass& procSites = m_vClasses[ iClass ];
+        Site* s = procSites.at( c, dom.randomGen->getIntRandom( 0, procSites.size( c ) - 1 ) );
+
+        int iProc = m_vClassProcess[ iClass ];
+        Process* proc = dom.processes[ iProc ];
+        proc->perform( s, *dom.affected );
+        dom.events[ iClass ]++;
+
+        for ( Site* affectedSite:*dom.affected ){
+            if ( m_vCellOf[ affectedSite->getID() ] != c ){
+                dom.deferred.push_back( affectedSite );
+                continue;
+            }
+
+            for ( int dep:m_vDependents[ iProc ] )
+                mf_classify( dom.processes[ dep ], dep, affectedSite );
+        }
+    }
+
+    dom.busy = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+}
+
+void SublatticeEngine::mf_reevaluate( Site* s )
+{
+    for ( int id:m_vRuled )
+        mf_classify( m_vProcesses[ id ], id, s );
+}
+
+void SublatticeEngine::mf_classify( Process* p, int id, Site* s )
+{
+    //The rule is evaluated once for all the bins of the process
+    int bin = p->getBin( s );
+    for ( int b = 0; b < p->getNumBins(); b++ ){
+        if ( b == bin )
+            m_vClasses[ m_vFirstClass[ id ] + b ].insert( s );
+        else
+            m_vClasses[ m_vFirstClass[ id ] + b ].erase( s );
+    }
+}
+
+double SublatticeEngine::getEfficiency()
+{
+    if ( m_dWallTime <= 0.0 )
+        return 0.0;
+
+    return m_dBusyTime/( m_dWallTime*m_iThreads );
+}
+
+}
@@ -0,0 +1,185 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#ifndef SUBLATTICE_ENGINE_H
+#define SUBLATTICE_ENGINE_H
+
+#include <vector>
+#include <string>
+
+#include "cell_class.h"
+#include "site_class.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+class Lattice;
+namespace SurfaceTiles { class Site; }
+namespace MicroProcesses { class Process; class AffectedSites; }
+namespace RandomGen { class RandomGenerator; }
+
+namespace Engine
+{
+
+/** Synchronous sublattice parallel kMC (Shim and Amar, Phys. Rev. B 71, 125432, 2005).
+ * The lattice is split in px x py domains along its x (column) and y (row) indices, one per thread, and
+ * every domain in 2 x 2 quadrants (the cells). In each time window all the threads perform kMC
+ * at the same time in the same quadrant of their domain; an event that would exceed the window is rejected.
+ * A cycle visits the four quadrants in random order and advances the time by one window.
+ * Active quadrants of different domains are separated by a whole inactive quadrant,
+ * so the threads never change or read the same sites as long as a quadrant is wider than the range
+ * of the processes (MIN_QUADRANT sites). Affected sites outside the active quadrant are re-evaluated
+ * serially at the end of the window.
+ *
+ * Each thread has its own copies of the processes with their own random generator. */
+class SublatticeEngine
+{
+public:
+    /// The minimum width of a quadrant: a perform changes sites up to the 1st neighbours,
+    /// the affected sites reach the 2nd neighbours and their rules read the 3rd neighbours.
+    static const int MIN_QUADRANT = 5;
+
+    /// Constructor. The processes are indexed by their ID and classes holds the current classes of their bins
+    /// (firstClass: the class of the first bin of each process, rates: the rate constant of each class).
+    /// dependents holds for each process the IDs of the processes whose rules it may change.
+    /// randomGens holds one random generator per thread (owned by the engine after construction).
+    SublatticeEngine( Lattice* lattice,
+                      const vector< MicroProcesses::Process* >& processes,
+                      const vector< SiteClass* >& classes,
+                      const vector<int>& firstClass,
+                      const vector<double>& rates,
+                      const vector< vector<int> >& dependents,
+                      const vector< RandomGen::RandomGenerator* >& randomGens,
+                      double window );
+
+    /// Destructor
+    virtual ~SublatticeEngine();
+
+    /// Returns an empty string if the lattice can be split for this number of threads or the reason why not.
+    static string checkDomains( Lattice* lattice, int threads );
+
+    /// Performs kMC in the given quadrant (0 - 3) of all the domains for one time window
+    /// and re-evaluates the deferred affected sites. Returns the number of events performed.
+    long runWindow( int quadrant );
+
+    /// Returns the length of the time window
+    inline double getWindow(){ return m_dWindow; }
+
+    /// Returns the number of sites in class id
+    inline int getClassSize( int id ){ return m_vClasses[ id ].size(); }
+
+    /// Returns the number of threads
+    inline int getNumThreads(){ return m_iThreads; }
+
+    /// Returns the number of domains along x and y
+    inline int getDomainsX(){ return m_iPx; }
+    inline int getDomainsY(){ return m_iPy; }
+
+    /// Returns the parallel efficiency: the time the threads spent performing kMC over
+    /// the wall time of the windows (including synchronization) times the number of threads.
+    double getEfficiency();
+
+    /// Returns the wall time spent in the windows
+    inline double getWallTime(){ return m_dWallTime; }
+
+private:
+    /// The work of a thread for the current window
+    struct Domain {
+        /// The copies of the processes (indexed by ID)
+        vector< MicroProcesses::Process* > processes;
+
+        /// The random generator of the thread
+        RandomGen::RandomGenerator* randomGen;
+
+        /// The sites affected by the last event of the thread
+        MicroProcesses::AffectedSites* affected;
+
+        /// The affected sites outside the active quadrant
+        vector< SurfaceTiles::Site* > deferred;
+
+        /// The number of events of each class in the current window
+        vector<int> events;
+
+        /// The time spent performing kMC in the current window
+        double busy;
+    };
+
+    /// Splits threads in px x py domains with px / py close to the ratio of the lattice sides.
+    static void mf_factorize( Lattice* lattice, int threads, int& px, int& py );
+
+    /// Performs kMC in cell c with the processes of domain d until the end of the window
+    void mf_runCell( int d, int c );
+
+    /// Re-evaluates the rules of all the processes for site s
+    void mf_reevaluate( SurfaceTiles::Site* s );
+
+    /// Moves site s to the class of its bin for process id (evaluated by p, the original or a copy of the process)
+    void mf_classify( MicroProcesses::Process* p, int id, SurfaceTiles::Site* s );
+
+    /// The lattice
+    Lattice* m_pLattice;
+
+    /// The processes (originals) indexed by ID
+    vector< MicroProcesses::Process* > m_vProcesses;
+
+    /// The classes of the bins of the processes split in cells (indexed by class ID)
+    vector< CellClass > m_vClasses;
+
+    /// The process ID of each class
+    vector<int> m_vClassProcess;
+
+    /// The class of the first bin of each process
+    vector<int> m_vFirstClass;
+
+    /// The rate constant of each class
+    vector<double> m_vRates;
+
+    /// For each process the processes whose rules it may change
+    vector< vector<int> > m_vDependents;
+
+    /// The processes whose rules are checked (not always possible)
+    vector<int> m_vRuled;
+
+    /// The cell of each site: 4 x domain + quadrant
+    vector<int> m_vCellOf;
+
+    /// The work of each thread
+    vector< Domain > m_vDomains;
+
+    /// The threads
+    ThreadPool* m_pPool;
+
+    /// The number of threads (domains)
+    int m_iThreads;
+
+    /// The number of domains along x and y
+    int m_iPx, m_iPy;
+
+    /// The length of the time window
+    double m_dWindow;
+
+    /// The time spent performing kMC by all the threads
+    double m_dBusyTime;
+
+    /// The wall time spent in the windows
+    double m_dWallTime;
+};
+
+}
+
+#endif // SUBLATTICE_ENGINE_H
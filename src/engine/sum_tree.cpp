@@ -0,0 +1,96 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "sum_tree.h"
+#include "binary_stream.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+
+SumTree::SumTree():m_iSize(0), m_iCapacity(1), m_vNodes(2, 0.0){}
+
+SumTree::~SumTree(){}
+
+void SumTree::resize( int n )
+{
+    m_iSize = n;
+    m_iCapacity = 1;
+    while ( m_iCapacity < n )
+        m_iCapacity *= 2;
+
+    m_vNodes.assign( 2*m_iCapacity, 0.0 );
+}
+
+void SumTree::update( int i, double val )
+{
+    int node = m_iCapacity + i;
+    m_vNodes[ node ] = val;
+
+    for ( node /= 2; node > 0; node /= 2 )
+        m_vNodes[ node ] = m_vNodes[ 2*node ] + m_vNodes[ 2*node + 1 ];
+}
+
+int SumTree::find( double val )
+{
+    if ( m_iSize == 0 || m_vNodes[ 1 ] <= 0.0 )
+        return -1;
+
+    int node = 1;
+    while ( node < m_iCapacity ){
+        double left = m_vNodes[ 2*node ];
+        // Go left only if the value falls there and there is something to pick
+        if ( val <= left && left > 0.0 )
+            node = 2*node;
+        else {
+            val -= left;
+            node = 2*node + 1;
+        }
+    }
+
+    // Rounding may lead past the last leaf with a value
+    int leaf = node - m_iCapacity;
+    while ( leaf > 0 && ( leaf >= m_iSize || m_vNodes[ m_iCapacity + leaf ] <= 0.0 ) )
+        leaf--;
+
+    return leaf;
+}
+
+void SumTree::rebuild()
+{
+    for ( int node = m_iCapacity - 1; node > 0; node-- )
+        m_vNodes[ node ] = m_vNodes[ 2*node ] + m_vNodes[ 2*node + 1 ];
+}
+
+void SumTree::write( ostream& out )
+{
+    vector<double> leaves( m_vNodes.begin() + m_iCapacity, m_vNodes.begin() + m_iCapacity + m_iSize );
+    Utils::writeBinary( out, leaves );
+}
+
+void SumTree::read( istream& in )
+{
+    vector<double> leaves;
+    Utils::readBinary( in, leaves );
+
+    resize( leaves.size() );
+    copy( leaves.begin(), leaves.end(), m_vNodes.begin() + m_iCapacity );
+    rebuild();
+}
+
+}
@@ -0,0 +1,84 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef SUM_TREE_H
+#define SUM_TREE_H
+
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+namespace Engine
+{
+
+/** A complete binary tree holding non negative values in its leaves and the
+ * partial sums in its internal nodes. Changing a leaf costs O(log N) and
+ * finding the leaf where a cumulative value falls costs O(log N).
+ * Every internal node is recomputed as the sum of its children (and not by adding
+ * differences) so the tree depends only on the values of its leaves. */
+class SumTree
+{
+public:
+    /// Constructor
+    SumTree();
+
+    /// Destructor
+    virtual ~SumTree();
+
+    /// Allocates n leaves and sets all of them to zero.
+    void resize( int n );
+
+    /// Returns the number of leaves.
+    inline int size(){ return m_iSize; }
+
+    /// Sets the value of leaf i and updates its ancestors.
+    void update( int i, double val );
+
+    /// Returns the value of leaf i.
+    inline double get( int i ){ return m_vNodes[ m_iCapacity + i ]; }
+
+    /// Returns the sum of all the leaves.
+    inline double getTotal(){ return m_vNodes[ 1 ]; }
+
+    /// Returns the first leaf i for which val <= leaf(0) + ... + leaf(i).
+    /// Leaves with zero value are never returned. Returns -1 if the tree is empty.
+    int find( double val );
+
+    /// Recomputes all the internal nodes from the leaves.
+    void rebuild();
+
+    /// Writes the leaves (for the checkpoints).
+    void write( ostream& out );
+
+    /// Reads the leaves written by write and rebuilds the tree.
+    void read( istream& in );
+
+private:
+    /// The number of leaves.
+    int m_iSize;
+
+    /// The number of leaves rounded up to a power of two.
+    int m_iCapacity;
+
+    /// The nodes of the tree. Node 1 is the root and the children of node i are 2i and 2i+1.
+    vector<double> m_vNodes;
+};
+
+}
+
+#endif // SUM_TREE_H
@@ -0,0 +1,86 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#include "thread_pool.h"
+
+namespace Engine
+{
+
+ThreadPool::ThreadPool( int n ):
+    m_iGeneration(0),
+    m_iPending(0),
+    m_bStop(false)
+{
+    for ( int i = 1; i < n; i++ )
+        m_vThreads.push_back( thread( &ThreadPool::mf_work, this, i ) );
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock( m_mutex );
+        m_bStop = true;
+    }
+    m_cvStart.notify_all();
+
+    for ( thread& t:m_vThreads )
+        t.join();
+}
+
+void ThreadPool::run( function<void(int)> task )
+{
+    {
+        lock_guard<mutex> lock( m_mutex );
+        m_task = task;
+        m_iPending = m_vThreads.size();
+        m_iGeneration++;
+    }
+    m_cvStart.notify_all();
+
+    task( 0 );
+
+    unique_lock<mutex> lock( m_mutex );
+    m_cvDone.wait( lock, [this](){ return m_iPending == 0; } );
+}
+
+void ThreadPool::mf_work( int i )
+{
+    long generation = 0;
+    while ( true ){
+        function<void(int)> task;
+        {
+            unique_lock<mutex> lock( m_mutex );
+            m_cvStart.wait( lock, [&](){ return m_bStop || m_iGeneration != generation; } );
+            if ( m_bStop )
+                return;
+
+            generation = m_iGeneration;
+            task = m_task;
+        }
+
+        task( i );
+
+        {
+            lock_guard<mutex> lock( m_mutex );
+            m_iPending--;
+        }
+        m_cvDone.notify_one();
+    }
+}
+
+}
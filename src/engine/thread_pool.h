@@ -0,0 +1,82 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+namespace Engine
+{
+
+/** A fixed number of threads that run the same task together. run( task ) calls task( i )
+ * for every i in [0, size()) - task( 0 ) in the calling thread - and returns when all have finished.
+ * The threads are kept alive between the calls, since the parallel engine calls run once per time window. */
+class ThreadPool
+{
+public:
+    /// Constructor. Starts n - 1 threads (the calling thread is the n-th).
+    ThreadPool( int n );
+
+    /// Destructor. Stops and joins the threads.
+    virtual ~ThreadPool();
+
+    /// Runs task( i ) for i in [0, size()) and waits for all of them.
+    void run( function<void(int)> task );
+
+    /// Returns the number of threads including the calling thread.
+    inline int size(){ return m_vThreads.size() + 1; }
+
+private:
+    /// The loop of thread i: waits for a new task, runs it and reports that it has finished.
+    void mf_work( int i );
+
+    /// The threads (1 ... n-1)
+    vector<thread> m_vThreads;
+
+    /// The current task
+    function<void(int)> m_task;
+
+    /// Protects the members below
+    mutex m_mutex;
+
+    /// Wakes the threads when there is a new task
+    condition_variable m_cvStart;
+
+    /// Wakes the calling thread when all the threads have finished
+    condition_variable m_cvDone;
+
+    /// Increased for every new task
+    long m_iGeneration;
+
+    /// The number of threads that have not finished the current task
+    int m_iPending;
+
+    /// True when the threads must exit
+    bool m_bStop;
+};
+
+}
+
+#endif // THREAD_POOL_H
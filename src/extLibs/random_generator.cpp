@@ -1,4 +1,5 @@
 #include "random_generator.h"
+#include "binary_stream.h"
 
 namespace RandomGen {
 
@@ -19,4 +20,9 @@ double RandomGenerator::getDoubleRandom() { return m_mersenne->Random(); }
 
 int RandomGenerator::getIntRandom( int Min, int Max ) { return m_mersenne->IRandom( Min, Max ); }
 
+//The Mersenne twister holds only its state vector, the index and the limits of the last interval
+void RandomGenerator::writeState( ostream& out ) { Utils::writeBinary( out, *m_mersenne ); }
+
+void RandomGenerator::readState( istream& in ) { Utils::readBinary( in, *m_mersenne ); }
+
 }
@@ -27,6 +27,12 @@ class RandomGenerator : public Pointers
     /// Returns a random floating point number from a normal distribution between 0 and 1
     double getDoubleRandom();
 
+    /// Writes the full state of the generator (for the checkpoints)
+    void writeState( ostream& out );
+
+    /// Reads the state written by writeState. The generator continues exactly from where it was written.
+    void readState( istream& in );
+
     /// Returns a random integer number from the interval [Min,Max]
     int getIntRandom( int Min, int Max );
 
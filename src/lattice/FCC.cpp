@@ -31,9 +31,10 @@ void FCC::readSpeciesFromFile() { cout << "Reading file for species is not suppo
 void FCC::build()
 {
     // The sites of the lattice.
+    m_arrays.resize( getSize() );
     m_vSites.resize( getSize() );
     for ( int i = 0; i < m_vSites.size(); i++)
-        m_vSites[ i ] = new Site();
+        m_vSites[ i ] = new Site( i, &m_arrays );
 
     if ( m_sOrient == "111"){
         if ( m_iSizeX%2 != 0 || m_iSizeX%2 != 0){
@@ -504,12 +505,12 @@ void FCC::mf_neigh_110()
 
     //A very simple test that all neighs have been defined at least in number
     for ( int i = 0; i < getSize(); i++){
-        if ( m_vSites[ i ]->get1stNeihbors()[ 0 ].size() != 4 ){
+        if ( m_vSites[ i ]->get1stNeihbors( 0 ).size() != 4 ){
             cout << "Check level 0 neighs in site: " << i << endl;
             EXIT
         }
 
-        if ( m_vSites[ i ]->get1stNeihbors()[ 0 ].size() != 4 ){
+        if ( m_vSites[ i ]->get1stNeihbors( 0 ).size() != 4 ){
             cout << "Check level 0 neighs in site: " << i << endl;
             EXIT
         }
@@ -979,7 +980,7 @@ void FCC::mf_neigh_111()
 int FCC::calculateNeighNum( int id,  const int level )
 {
     int neighs = 0;
-    vector<Site* > sites = m_vSites[ id ]->get1stNeihbors()[ level ];
+    SiteRange sites = m_vSites[ id ]->get1stNeihbors( level );
 
     switch (level){
     case -1:
@@ -1029,7 +1030,7 @@ int FCC::calculateNeighNum( int id,  const int level )
         for ( int k = 0; k < m_lattice->getSite( i*m_lattice->getX() + j )->getHeight(); k+=2){
                 int max = m_lattice->getSite(i*m_lattice->getX() + j)->getHeight()-1;
                 if ( k%2 == 0){
-                    if ( m_lattice->getSite(i*m_lattice->getX() + j)->getLabel() == "HAMD" ) {
+                    if ( m_lattice->getSite(i*m_lattice->getX() + j)->getLabelName() == "HAMD" ) {
                         if ( k != max  )
                             file << "Cu" << " " << x << " "  <<  y  << " " << h << endl;
                         else if ( k == max )
@@ -1040,7 +1041,7 @@ int FCC::calculateNeighNum( int id,  const int level )
                     h = h + a;
                 }
                 else {
-                    if ( m_lattice->getSite(i*m_lattice->getX() + j)->getLabel() == "HAMD" ) {
+                    if ( m_lattice->getSite(i*m_lattice->getX() + j)->getLabelName() == "HAMD" ) {
                         if ( k != max  )
                             file << "C" << " " << x1 << " "  <<  y1  << " " << h1 << endl;
                         else if ( k == max )
@@ -1105,7 +1106,7 @@ void FCC::writeXYZ( string filename )
                 for ( int k = 0; k < m_lattice->getSite( i*m_lattice->getX() + j )->getHeight(); k+=2){
  //                   file << "Cu" << " " << x << " "  <<  y  << " " << h << endl;
 
-                    if ( m_lattice->getSite(i*m_lattice->getX() + j)->getLabel() == "HAMD" ) {
+                    if ( m_lattice->getSite(i*m_lattice->getX() + j)->getLabelName() == "HAMD" ) {
                         if ( k != max  )
                             file << "Cu" << " " << x << " "  <<  y  << " " << h << endl;
                         else if ( k == max )
@@ -1128,7 +1129,7 @@ void FCC::writeXYZ( string filename )
                 for ( int k = 1; k < m_lattice->getSite( i*m_lattice->getX() + j )->getHeight(); k+=2){
 //                    file << "C" << " " << x1 << " "  <<  y1  << " " << h1 << endl;
 
-                    if ( m_lattice->getSite(i*m_lattice->getX() + j)->getLabel() == "HAMD" ) {
+                    if ( m_lattice->getSite(i*m_lattice->getX() + j)->getLabelName() == "HAMD" ) {
                         if ( k != max )
                             file << "C" << " " << x1 << " "  <<  y1  << " " << h1 << endl;
                         else if ( k == max )
@@ -1175,5 +1176,3 @@ void FCC::check()
 
     cout << "Activation: " << endl;
 }
-
-unordered_map<string, double> FCC::computeCoverages( vector<string> species){ }
@@ -68,7 +68,6 @@ public:
 
     void buildSteps(int, int);
 
-    unordered_map<string, double > computeCoverages( vector<string> species ) override;
 
 protected:
     /// Build the first neighbours for the FCC(100) lattice.
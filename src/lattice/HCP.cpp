@@ -107,9 +107,10 @@ void HCP::build()
     }
 
     // The sites of the lattice.
-    m_vSites.resize(getSize());
+    m_arrays.resize( getSize() );
+    m_vSites.resize( getSize() );
     for (int i = 0; i < m_vSites.size(); i++)
-        m_vSites[i] = new Site();
+        m_vSites[i] = new Site( i, &m_arrays );
 
     // This is OK
     for (int i = 0; i < m_iSizeX; i++)
@@ -131,7 +132,7 @@ void HCP::build()
     for (int i = 0; i < m_iSizeY; i++)
     {
         for (int j = 0; j < m_iSizeX; j++)
-            m_vSites[i * m_iSizeX + j]->setLabel(m_sLabel);
+            m_vSites[i * m_iSizeX + j]->setLabel( SpeciesRegistry::intern( m_sLabel ) );
     }
 }
 
@@ -469,20 +470,3 @@ int HCP::calculateNeighNum(int id)
     return neighs;
 }
 
-unordered_map<string, double> HCP::computeCoverages( vector<string> species)
-{
-    for ( string name:species){
-        m_mCoverages[ name ] = 0.;
-
-        int iCount = 0;
-        for ( int i =0; i< getSize(); i++){
-            if ( m_vSites[ i ]->getLabel().compare( name ) == 0 )
-                iCount++;
-        }
-
-        m_mCoverages[ name ] = (double)iCount/getSize();
-    }
-
-    return m_mCoverages;
-}
-
@@ -70,7 +70,6 @@ public:
 
     inline bool isStepped() { return m_bHasSteps; }
 
-    unordered_map<string, double> computeCoverages( vector<string> species);
 
 protected:
     /// Build the neighbours for the BCC lattice for each site.
@@ -27,7 +27,7 @@ SimpleCubic::SimpleCubic(Apothesis *apothesis) : Lattice(apothesis), m_iMinNeigs
 void SimpleCubic::buildSteps()
 {    
     int iPerStep = 0;
-    if ( m_vSites.size()%m_iNumSteps != 0){
+    if ( m_iSizeX%m_iNumSteps != 0){
         cout << "Cannot create  stepped surface because it cannot be divided exaclty." << endl;
         EXIT
     }
@@ -51,9 +51,6 @@ void SimpleCubic::buildSteps()
         iStep++;
     }
 
-    for ( int i = 0; i< m_vSites.size(); i++)
-        calculateNeighNum( i );
-
     int h = getSite( m_iSizeY-1, m_iSizeX-1)->getHeight() ;
     m_iStepDiff = abs( getSite( m_iSizeY-1, m_iSizeX-1)->getHeight() - getSite( 0, 0 )->getHeight() ) + 1;
 
@@ -61,6 +58,18 @@ void SimpleCubic::buildSteps()
         getSite( j, 0 )->setLowerStep( true );
         getSite( j, m_iSizeX - 1  )->setHigherStep( true );
     }
+
+    //The neighbours across the edge (the lower step next to the higher one) are compared to the height of the step.
+    //The neighbour index is built before the steps.
+    for ( int i = 0; i < getSize(); i++ ){
+        for ( int k = m_arrays.neighBegin( i ); k < m_arrays.neighEnd( i ); k++ ){
+            int j = m_arrays.neighIndex[ k ];
+            if ( ( m_arrays.stepFlags[ i ] & SiteArrays::LOWER_STEP ) && ( m_arrays.stepFlags[ j ] & SiteArrays::HIGHER_STEP ) )
+                m_arrays.neighOffset[ k ] = m_iStepDiff + 1;
+            else if ( ( m_arrays.stepFlags[ j ] & SiteArrays::LOWER_STEP ) && ( m_arrays.stepFlags[ i ] & SiteArrays::HIGHER_STEP ) )
+                m_arrays.neighOffset[ k ] = -m_iStepDiff + 1;
+        }
+    }
 }
 
 void SimpleCubic::readHeightsFromFile() {
@@ -136,7 +145,7 @@ void SimpleCubic::readSpeciesFromFile(){
         for (int i = 0; i < m_iSizeX; ++i) {
             for (int j = 0; j < m_iSizeY; ++j) {
                 icount = i * m_iSizeY + j;
-                m_vSites[icount]->setLabel( species[ i ][ j ] );
+                m_vSites[icount]->setLabel( SpeciesRegistry::intern( species[ i ][ j ] ) );
 
                 if ( species[ i ][ j ].find("*") != std::string::npos)
                     m_vSites[ icount ]->setOccupied( true);
@@ -370,39 +379,9 @@ void SimpleCubic::writeLatticeHeights( double time, int step )
 
     for (int i = 0; i < m_iSizeY; i++){
         for (int j = 0; j < m_iSizeX; j++)
-            file << m_vSites[ i*m_iSizeX + j ]->getLabel() + to_string( m_vSites[ i*m_iSizeX + j ]->getID() )  << "\t" << "( " << m_vSites[ i*m_iSizeX + j ]->getHeight() << " ) " ;
+            file << m_vSites[ i*m_iSizeX + j ]->getLabelName() + to_string( m_vSites[ i*m_iSizeX + j ]->getID() )  << "\t" << "( " << m_vSites[ i*m_iSizeX + j ]->getHeight() << " ) " ;
         file  << endl;
     }
 
     file.close();
 }
-
-int SimpleCubic::calculateNeighNum( int id )
-{
-    int neighs = 1;
-    for ( Site* s:m_vSites[ id ]->getNeighs() ) {
-        if ( s->getHeight() >= m_vSites[ id ]->getHeight() )
-            neighs++;
-    }
-
-    // THIS IS BAD! REFACTOR ....
-    m_vSites[ id ]->setNeighsNum( neighs );
-    return neighs;
-}
-
-unordered_map<string, double> SimpleCubic::computeCoverages( vector<string> species ) {
-    for ( string name:species){
-        m_mCoverages[ name ] = 0.;
-
-        int iCount = 0;
-        for ( int i =0; i< getSize(); i++){
-            if ( m_vSites[ i ]->getLabel().compare( name ) == 0 )
-                iCount++;
-        }
-
-        m_mCoverages[ name ] = (double)iCount/getSize();
-    }
-
-    return m_mCoverages;
-}
-
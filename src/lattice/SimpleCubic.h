@@ -57,9 +57,6 @@ public:
   /// Create stepped surface
   void buildSteps() override;
 
-  /// Calculate the number of neighbor based on the height
-  int calculateNeighNum( int id );
-
   void writeLatticeHeights( double, int );
 
   void readHeightsFromFile() override;
@@ -70,7 +67,6 @@ public:
 
   inline bool isStepped(){return m_bHasSteps;}
 
-  unordered_map<string, double> computeCoverages( vector<string> species) override;
 
 protected:
   /// Build the neighbours for the BCC lattice for each site.
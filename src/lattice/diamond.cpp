@@ -30,9 +30,10 @@ void Diamond::readSpeciesFromFile() { cout << "Reading file for species is not s
 
 void Diamond::build(){
     // The sites of the lattice.
-    m_vSites.resize(getSize());
+    m_arrays.resize( getSize() );
+    m_vSites.resize( getSize() );
     for (int i = 0; i < m_vSites.size(); i++)
-        m_vSites[i] = new Site();
+        m_vSites[i] = new Site( i, &m_arrays );
 
     // This is OK
     for (int i = 0; i < m_iSizeX; i++)
@@ -50,7 +51,7 @@ void Diamond::build(){
     for (int i = 0; i < m_iSizeY; i++)
     {
         for (int j = 0; j < m_iSizeX; j++)
-            m_vSites[i * m_iSizeX + j]->setLabel(m_sLabel);
+            m_vSites[i * m_iSizeX + j]->setLabel( SpeciesRegistry::intern( m_sLabel ) );
     }
 }
 
@@ -76,5 +77,3 @@ void Diamond::mf_neigh() {
         m_vSites[ site ]->setNeigh( m_vSites[ x * L + ((y - 1 + L) % L) ]); //Up
     }
 }
-
-unordered_map<string, double> Diamond::computeCoverages( vector<string> species){ }
@@ -57,7 +57,6 @@ public:
     /// Write the lattice in XYZ format in a filename
     void writeXYZ( string );
 
-    unordered_map<string, double > computeCoverages( vector<string> species ) override;
 
 protected:
     /// Build the first neighbours for the diamond lattice.
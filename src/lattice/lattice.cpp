@@ -16,8 +16,10 @@
 //============================================================================
 
 #include "lattice.h"
+#include "binary_stream.h"
+#include "affected_sites.h"
 
-Lattice::Lattice(Apothesis *apothesis) : Pointers(apothesis),m_iStepDiff(0),m_bHeightsFromFile(false),m_bSpeciesFromFile(false)
+Lattice::Lattice(Apothesis *apothesis) : Pointers(apothesis),m_iStepDiff(0),m_bSpeciesCounted(false),m_bHeightsFromFile(false),m_bSpeciesFromFile(false)
 {
 }
 
@@ -46,28 +48,185 @@ void Lattice::setY(int y) { m_iSizeY = y; }
 
 void Lattice::buildSites() {
 
+    m_arrays.resize( getSize() );
     m_vSites.resize( getSize() );
-    for (int i = 0; i < m_vSites.size(); i++) {
-        m_vSites[i] = new Site();
-        m_vSites[i]->setID(i);
+    for (int i = 0; i < m_vSites.size(); i++)
+        m_vSites[i] = new Site( i, &m_arrays );
+}
+
+void Lattice::buildNeighbourIndex() {
+    m_arrays.buildNeighbourIndex( m_vSites );
+}
+
+void Lattice::computeCoordination() {
+    for (int i = 0; i < m_arrays.size(); i++)
+        m_arrays.neighsNum[ i ] = m_arrays.coordination( i );
+}
+
+void Lattice::updateCoordination( int id ) {
+
+    m_arrays.neighsNum[ id ] = m_arrays.coordination( id );
+
+    for ( int k = m_arrays.revBegin( id ); k < m_arrays.revEnd( id ); k++ )
+        m_arrays.neighsNum[ m_arrays.revIndex[ k ] ] = m_arrays.coordination( m_arrays.revIndex[ k ] );
+}
+
+void Lattice::copyFrom( Lattice* lattice ) {
+
+    m_iSizeX = lattice->m_iSizeX;
+    m_iSizeY = lattice->m_iSizeY;
+    m_iHeight = lattice->m_iHeight;
+    m_Type = lattice->m_Type;
+    m_sType = lattice->m_sType;
+    m_hasSteps = lattice->m_hasSteps;
+    m_iNumSteps = lattice->m_iNumSteps;
+    m_iStepHeight = lattice->m_iStepHeight;
+    m_sOrient = lattice->m_sOrient;
+    m_iStepDiff = lattice->m_iStepDiff;
+
+    m_arrays = lattice->m_arrays;
+
+    m_vSites.resize( lattice->m_vSites.size() );
+    for (int i = 0; i < m_vSites.size(); i++)
+        m_vSites[i] = new Site( *lattice->m_vSites[i] );
+
+    for (int i = 0; i < m_vSites.size(); i++)
+        m_vSites[i]->remapSites( m_vSites, &m_arrays );
+}
+
+void Lattice::writeState( ostream& out ) {
+
+    //The names of the species are stored once and each site keeps their index
+    //(the IDs of the species depend on the order they are read in)
+    vector<string> labels;
+    unordered_map<int, int> index;
+    auto labelIndex = [&]( int label ){
+        auto it = index.find( label );
+        if ( it != index.end() )
+            return it->second;
+
+        labels.push_back( SpeciesRegistry::getName( label ) );
+        return index[ label ] = labels.size() - 1;
+    };
+
+    int n = m_arrays.size();
+    vector<int> label( n ), belowLabel( n );
+    for (int i = 0; i < n; i++) {
+        label[i] = labelIndex( m_arrays.labels[i] );
+        belowLabel[i] = labelIndex( m_arrays.belowLabels[i] );
     }
+
+    Utils::writeBinary( out, (long)labels.size() );
+    for ( string& l:labels )
+        Utils::writeBinary( out, l );
+
+    Utils::writeBinary( out, m_arrays.heights );
+    Utils::writeBinary( out, m_arrays.neighsNum );
+    Utils::writeBinary( out, label );
+    Utils::writeBinary( out, belowLabel );
+    Utils::writeBinary( out, m_arrays.occupied );
+}
+
+bool Lattice::readState( istream& in ) {
+
+    long numLabels = 0;
+    Utils::readBinary( in, numLabels );
+    vector<int> labels( max( numLabels, 0L ) );
+    for ( int& l:labels ) {
+        string name;
+        Utils::readBinary( in, name );
+        l = SpeciesRegistry::intern( name );
+    }
+
+    vector<int> heights, neighs, label, belowLabel;
+    vector<char> occupied;
+    Utils::readBinary( in, heights );
+    Utils::readBinary( in, neighs );
+    Utils::readBinary( in, label );
+    Utils::readBinary( in, belowLabel );
+    Utils::readBinary( in, occupied );
+
+    if ( !in || heights.size() != m_arrays.size() )
+        return false;
+
+    m_arrays.heights = heights;
+    m_arrays.neighsNum = neighs;
+    m_arrays.occupied = occupied;
+    for (int i = 0; i < m_arrays.size(); i++) {
+        m_arrays.labels[i] = labels.at( label[i] );
+        m_arrays.belowLabels[i] = labels.at( belowLabel[i] );
+    }
+
+    return true;
 }
 
 void Lattice::setInitialHeight(int height) {
 
+    m_iHeight = height;
     for (int i = 0; i < m_vSites.size(); i++)
         m_vSites[i]->setHeight( height);
 }
 
 void Lattice::setInitialSpecies(string label) {
 
+    int species = SpeciesRegistry::intern( label );
     for (int i = 0; i < m_vSites.size(); i++)
-        m_vSites[ i ]->setLabel( label );
+        m_vSites[ i ]->setLabel( species );
+}
+
+void Lattice::mf_countSpecies()
+{
+    m_vCountedLabels = m_arrays.labels;
+
+    m_vSpeciesCount.assign( SpeciesRegistry::size(), 0 );
+    for ( int label:m_vCountedLabels )
+        if ( label != SpeciesRegistry::NONE )
+            m_vSpeciesCount[ label ]++;
+
+    m_bSpeciesCounted = true;
+}
+
+void Lattice::updateSpeciesCounts( const MicroProcesses::AffectedSites& affected )
+{
+    //The sites are counted when the coverages are needed
+    if ( !m_bSpeciesCounted )
+        return;
+
+    for ( Site* s:affected ){
+        int id = s->getID();
+        int label = m_arrays.labels[ id ];
+        int old = m_vCountedLabels[ id ];
+        if ( label == old )
+            continue;
+
+        if ( old != SpeciesRegistry::NONE )
+            m_vSpeciesCount[ old ]--;
+
+        if ( label != SpeciesRegistry::NONE ){
+            //A species interned after the counting
+            if ( label >= m_vSpeciesCount.size() )
+                m_vSpeciesCount.resize( label + 1, 0 );
+
+            m_vSpeciesCount[ label ]++;
+        }
+
+        m_vCountedLabels[ id ] = label;
+    }
 }
 
-vector<Site *> Lattice::getSites()
+vector< pair<string, double> > Lattice::computeCoverages( const vector<string>& species )
 {
-    return m_vSites;
+    if ( !m_bSpeciesCounted )
+        mf_countSpecies();
+
+    vector< pair<string, double> > coverages;
+    for ( const string& name:species ){
+        int id = SpeciesRegistry::find( name );
+        int count = ( id != SpeciesRegistry::NONE && id < m_vSpeciesCount.size() ) ? m_vSpeciesCount[ id ] : 0;
+        coverages.push_back( make_pair( name, (double)count/getSize() ) );
+    }
+
+    return coverages;
 }
 
 string Lattice::getTypeAsString(){ return  m_sType; }
@@ -95,8 +254,6 @@ void Lattice::readHeightsFromFile(){;}
 
 void Lattice::readSpeciesFromFile(){;}
 
-Site* Lattice::getSite(int id) { return m_vSites[id]; }
-
 Site* Lattice::getSite(int i, int j)
 {
     return m_vSites[ i*m_iSizeX + j ];
@@ -106,7 +263,7 @@ void Lattice::print()
 {
     for (int i = 0; i < m_iSizeY; i++){
         for (int j = 0; j < m_iSizeX; j++)
-            cout << m_vSites[ i*m_iSizeX + j ]->getLabel() + to_string( m_vSites[ i*m_iSizeX + j ]->getID() )  << "\t" << "( " << m_vSites[ i*m_iSizeX + j ]->getHeight() << " ) " ;
+            cout << m_vSites[ i*m_iSizeX + j ]->getLabelName() + to_string( m_vSites[ i*m_iSizeX + j ]->getID() )  << "\t" << "( " << m_vSites[ i*m_iSizeX + j ]->getHeight() << " ) " ;
         cout  << endl;
     }
 }
@@ -127,14 +284,14 @@ void Lattice::printNeighs( int ID )
 
     if ( ID < getSize() ){
         cout << "Level 0 neighs: ";
-        for ( int i = 0; i< m_vSites[ ID ]->get1stNeihbors()[ 0 ].size(); i++ )
-            cout << m_vSites[ ID ]->get1stNeihbors()[ 0 ].at( i )->getID() << " ";
+        for ( Site* s:m_vSites[ ID ]->get1stNeihbors( 0 ) )
+            cout << s->getID() << " ";
 
         cout << endl;
 
         cout << "Level -1 neighs: ";
-        for ( int i = 0; i< m_vSites[ ID ]->get1stNeihbors()[ -1 ].size(); i++ )
-            cout << m_vSites[ ID ]->get1stNeihbors()[ -1 ].at( i )->getID() << " ";
+        for ( Site* s:m_vSites[ ID ]->get1stNeihbors( -1 ) )
+            cout << s->getID() << " ";
 
         cout << endl;
 
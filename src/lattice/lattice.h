@@ -25,6 +25,7 @@
 #include <fstream>
 #include "pointers.h"
 #include "site.h"
+#include "site_arrays.h"
 #include "errorhandler.h"
 #include <set>
 
@@ -32,6 +33,8 @@ using namespace std;
 using namespace Utils;
 using namespace SurfaceTiles;
 
+namespace MicroProcesses { class AffectedSites; }
+
 class Lattice: public Pointers
   {
   public:
@@ -80,13 +83,13 @@ class Lattice: public Pointers
     Lattice* getLattice();
 
     /// Returns a site with a specific id.
-    Site* getSite( int id);
+    inline Site* getSite( int id ){ return m_vSites[ id ]; }
 
     /// Returns a site with a specific id as in 2D space.
     Site* getSite( int i, int j);
 
-    /// Returns all the sites of the lattice.
-    vector<Site*> getSites();
+    /// Returns all the sites of the lattice (indexed by their ID).
+    inline const vector<Site*>& getSites(){ return m_vSites; }
 
     /// Init the lattice.
     void init();
@@ -117,6 +120,30 @@ class Lattice: public Pointers
 
     virtual void buildSites();
 
+    /// Builds the compressed neighbour index of the arrays from the neighbours of the sites (called after the lattice is built)
+    void buildNeighbourIndex();
+
+    /// Returns the state of the sites as arrays indexed by the ID of the site
+    inline SiteArrays& getArrays(){ return m_arrays; }
+
+    /// Computes the coordination of all the sites (SiteArrays::neighsNum) from their heights.
+    /// Called once the neighbour index and the steps are built.
+    void computeCoordination();
+
+    /// Updates the coordination of site id and of the sites that have it as neighbour after the height of the site changed.
+    /// Every perform that changes a height calls it, so the rules read the coordination of a site in O(1).
+    void updateCoordination( int id );
+
+    /// Copies the sites (with their neighbours, heights and labels) and the steps of an already built lattice of the same type.
+    /// Used instead of building the lattice when many replicas of the same simulation run.
+    void copyFrom( Lattice* lattice );
+
+    /// Writes the state of the sites that changes during the run: heights, labels, below labels, occupancy and number of neighbours (for the checkpoints)
+    void writeState( ostream& out );
+
+    /// Reads the state written by writeState. Returns false if it was written for a lattice of different size.
+    bool readState( istream& in );
+
     //Set true if the lattice has steps
     inline void setSteps(bool hasSteps){m_hasSteps = hasSteps; }
 
@@ -162,8 +189,17 @@ class Lattice: public Pointers
     /// Returns the lattice type as string
     string getTypeAsString();
 
-    /// Returns the coverages of each species adsorbed
-    virtual unordered_map<string, double > computeCoverages( vector<string> species ){}
+    /// Returns the coverage of each of the species in the order they are given. O(species): the number of sites
+    /// of each species is counted once and then updated from the sites affected by the events (updateSpeciesCounts).
+    vector< pair<string, double> > computeCoverages( const vector<string>& species );
+
+    /// Updates the number of sites of each species after an event from the sites it affected
+    /// (the sites whose species changed must be among them)
+    void updateSpeciesCounts( const MicroProcesses::AffectedSites& affected );
+
+    /// The sites of each species are counted again when the coverages are needed next
+    /// (the species changed outside the events, e.g. restart or the parallel engine)
+    inline void invalidateSpeciesCounts(){ m_bSpeciesCounted = false; }
 
 protected:
     /// The size of the lattice in the x-dimension.
@@ -190,6 +226,9 @@ protected:
     /// The sites that consist the lattice.
     vector<Site* > m_vSites;
 
+    /// The state of the sites (the sites are handles to their position in these arrays)
+    SiteArrays m_arrays;
+
     /// True if the lattice has steps (comes from the input file if the Step keyword is found).
     bool m_hasSteps = false;
 
@@ -210,8 +249,17 @@ protected:
     /// The label of the lattice species
     string m_sLabel;
 
-    /// The coveraages at each time
-    unordered_map<string, double> m_mCoverages;
+    /// The number of sites of each species (by its ID in the SpeciesRegistry)
+    vector<int> m_vSpeciesCount;
+
+    /// The species of each site when the sites were counted (or updated)
+    vector<int> m_vCountedLabels;
+
+    /// True if m_vSpeciesCount corresponds to the lattice
+    bool m_bSpeciesCounted;
+
+    /// Counts the sites of each species
+    void mf_countSpecies();
 
     /// Flag to know if the height is variable across sites
     bool m_bHeightsFromFile;
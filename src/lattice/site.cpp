@@ -23,14 +23,62 @@
 namespace SurfaceTiles
 {
 
-Site::Site():m_phantom(false),m_isLowerStep(false), m_isHigherStep(false), m_bIsOccupied(false)
+Site::Site( int id, SiteArrays* arrays ):m_iID(id), m_pArrays(arrays), m_pCoupledSite(nullptr)
   {
-      vector<Site* > vec;
-      m_m1stNeighs = { {-1, vec}, { 0, vec }, {1, vec }, };
+      for ( Site*& s:m_aNeighPosition )
+          s = nullptr;
   }
 
   Site::~Site() {}
 
+  void Site::remapSites( const vector<Site*>& sites, SiteArrays* arrays )
+  {
+      m_pArrays = arrays;
+
+      for ( Site*& s:m_vNeigh )
+          s = sites[ s->getID() ];
+
+      for ( Site*& s:m_aNeighPosition )
+          if ( s )
+              s = sites[ s->getID() ];
+
+      for ( auto &p:m_m1stNeighs )
+          for ( Site*& s:p.second )
+              s = sites[ s->getID() ];
+
+      if ( m_pCoupledSite )
+          m_pCoupledSite = sites[ m_pCoupledSite->getID() ];
+  }
+
+  void SiteArrays::buildNeighbourIndex( const vector<Site*>& sites )
+  {
+      neighStart.assign( sites.size() + 1, 0 );
+      neighIndex.clear();
+
+      for ( int i = 0; i < sites.size(); i++ ){
+          for ( Site* s:sites[ i ]->getNeighs() )
+              neighIndex.push_back( s->getID() );
+
+          neighStart[ i + 1 ] = neighIndex.size();
+      }
+
+      neighOffset.assign( neighIndex.size(), 0 );
+
+      //The reverse of the neighbour index
+      revStart.assign( sites.size() + 1, 0 );
+      for ( int k = 0; k < neighIndex.size(); k++ )
+          revStart[ neighIndex[ k ] + 1 ]++;
+
+      for ( int i = 0; i < sites.size(); i++ )
+          revStart[ i + 1 ] += revStart[ i ];
+
+      revIndex.resize( neighIndex.size() );
+      vector<int> fill( revStart.begin(), revStart.end() - 1 );
+      for ( int i = 0; i < sites.size(); i++ )
+          for ( int k = neighBegin( i ); k < neighEnd( i ); k++ )
+              revIndex[ fill[ neighIndex[ k ] ]++ ] = i;
+  }
+
 } // namespace SurfaceTiles
 
 #endif
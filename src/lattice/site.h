@@ -25,22 +25,53 @@
 #include <valarray>
 
 #include "process.h"
+#include "species_registry.h"
+#include "site_arrays.h"
 
 using namespace std;
 using namespace MicroProcesses;
 
 /**  The site is where a process will be performed. The lattice is
- * a series of sites put together in space with certain symmetry. */
+ * a series of sites put together in space with certain symmetry.
+ * The state of the site (height, species, occupancy) is stored in the arrays of the lattice (SiteArrays)
+ * at the position of its ID. */
 
 namespace SurfaceTiles
 {
 
+class Site;
+
+/** A view of consecutive sites (e.g. the neighbours of a site) that does not copy them.
+ * It is valid as long as the sites it views are not changed (the neighbours are set only when the lattice is built). */
+class SiteRange
+{
+public:
+    SiteRange():m_pBegin(nullptr), m_pEnd(nullptr){}
+    SiteRange( Site* const* begin, Site* const* end ):m_pBegin(begin), m_pEnd(end){}
+    SiteRange( const vector<Site*>& sites ):m_pBegin( sites.data() ), m_pEnd( sites.data() + sites.size() ){}
+
+    inline Site* const* begin() const { return m_pBegin; }
+    inline Site* const* end() const { return m_pEnd; }
+
+    /// Returns the number of sites
+    inline int size() const { return m_pEnd - m_pBegin; }
+
+    inline bool empty() const { return m_pBegin == m_pEnd; }
+
+    /// Returns the i-th site (not checked)
+    inline Site* operator[]( int i ) const { return m_pBegin[ i ]; }
+
+private:
+    Site* const* m_pBegin;
+    Site* const* m_pEnd;
+};
+
 class Site
 {
 public:
 
-    /// Contructor.
-    Site();
+    /// Contructor. The site keeps its state in the arrays at the position id.
+    Site( int id, SiteArrays* arrays );
 
     /// Destructor.
     virtual ~Site();
@@ -78,16 +109,16 @@ public:
     };
 
     /// Set the height of the particular site.
-    inline void setHeight( int h ) { m_iHeight = h; }
+    inline void setHeight( int h ) { m_pArrays->heights[ m_iID ] = h; }
 
     /// Get the height of the particular site.
-    inline int getHeight() { return m_iHeight; }
+    inline int getHeight() { return m_pArrays->heights[ m_iID ]; }
 
     /// Set the neigbours.
     inline void setNeigh(Site *s){ m_vNeigh.push_back(s); }
 
-    /// Get the neigbours at the same level.
-    inline vector<Site *> getNeighs() { return m_vNeigh; }
+    /// Get the neigbours at the same level (a view - nothing is copied).
+    inline SiteRange getNeighs() const { return SiteRange( m_vNeigh ); }
 
     /// Set an ID for this site.
     inline void setID(int id) { m_iID = id; }
@@ -96,57 +127,60 @@ public:
     inline int getID() { return m_iID; }
 
     /// Set the number of the neighbours according to the height of its neighbour sites
-    inline void setNeighsNum( int n ) { m_iNumNeighs = n; }
+    inline void setNeighsNum( int n ) { m_pArrays->neighsNum[ m_iID ] = n; }
 
     /// Returns the number of the neighbours according to the height of its neighbour sites (for PVD)
-    inline int getNeighsNum(){ return m_iNumNeighs; }
+    inline int getNeighsNum(){ return m_pArrays->neighsNum[ m_iID ]; }
 
     /// Set the neihbour position for this site.
-    inline void setNeighPosition(Site *s, NeighPoisition np) { m_mapNeigh[ np ] = s; }
+    inline void setNeighPosition(Site *s, NeighPoisition np) { m_aNeighPosition[ np ] = s; }
 
     /// Get the neihbour position for this site.
-    Site* getNeighPosition(NeighPoisition np){ return m_mapNeigh[np]; }
-
-    vector<string> getSpeciesName();
-
-    // Get the react species
-    inline valarray< int > getReactSpecies() { return m_vReacSpecies; }
+    Site* getNeighPosition(NeighPoisition np){ return m_aNeighPosition[np]; }
 
     /// Increase the height of the site by one
-    inline void increaseHeight( int i ){ m_iHeight += i; }
+    inline void increaseHeight( int i ){ m_pArrays->heights[ m_iID ] += i; }
 
     /// Decrease the height of the site by one
-    inline void decreaseHeight( int i ){ m_iHeight -= i; }
+    inline void decreaseHeight( int i ){ m_pArrays->heights[ m_iID ] -= i; }
 
     /// Set the first negihbors of this site
-    void set1stNeibors( int level, Site* s) { m_m1stNeighs.at( level ).push_back( s ); }
+    void set1stNeibors( int level, Site* s) { m_m1stNeighs[ level ].push_back( s ); }
 
-    /// Returns the 1st neigbors
-    inline map<int, vector<Site* > > get1stNeihbors() const { return m_m1stNeighs; }
+    /// Returns the 1st neigbors at a level (-1: below, 0: same, 1: upper level) as a view - empty if they are not set
+    inline SiteRange get1stNeihbors( int level ) const {
+        auto it = m_m1stNeighs.find( level );
+        if ( it == m_m1stNeighs.end() )
+            return SiteRange();
+        return SiteRange( it->second );
+    }
 
-    /// Returns true if is in lower step (used in the step case only)
-    void setLowerStep( bool b){ m_isLowerStep = b; }
+    /// Sets if the site is at the edge of the lower step (used in the step case only)
+    inline void setLowerStep( bool b ){ mf_setStepFlag( SiteArrays::LOWER_STEP, b ); }
 
-    /// Returns true if is in higher step (used in the step case only)
-    void setHigherStep( bool b) { m_isHigherStep = b; }
+    /// Sets if the site is at the edge of the higher step (used in the step case only)
+    inline void setHigherStep( bool b ){ mf_setStepFlag( SiteArrays::HIGHER_STEP, b ); }
 
     /// Returns true if is in lower step (used in the step case only)
-    bool isLowerStep(){ return m_isLowerStep; }
+    inline bool isLowerStep(){ return m_pArrays->stepFlags[ m_iID ] & SiteArrays::LOWER_STEP; }
 
     /// Returns true if is in higher step (used in the step case only)
-    bool isHigherStep() { return m_isHigherStep; }
+    inline bool isHigherStep(){ return m_pArrays->stepFlags[ m_iID ] & SiteArrays::HIGHER_STEP; }
+
+    /// Sets the species of this site (its ID in the SpeciesRegistry)
+    inline void setLabel( int species ){ m_pArrays->labels[ m_iID ] = species; }
 
-    /// Testing: adding species formula
-    inline void setLabel( string formula ){ m_sLabel = formula; }
+    /// Returns the ID of the species of this site
+    inline int getLabel(){ return m_pArrays->labels[ m_iID ]; }
 
-    /// Testing: geting species formula
-    inline string getLabel(){ return m_sLabel; }
+    /// Returns the name of the species of this site (for the output)
+    inline string getLabelName(){ return SpeciesRegistry::getName( getLabel() ); }
 
-    /// Testing: adding species formula
-    inline void setBelowLabel( string formula ){ m_sBelowLabel = formula; }
+    /// Sets the species of the site below this site
+    inline void setBelowLabel( int species ){ m_pArrays->belowLabels[ m_iID ] = species; }
 
-    /// Testing: geting species formula
-    inline string getBelowLabel(){ return m_sBelowLabel; }
+    /// Returns the ID of the species of the site below this site
+    inline int getBelowLabel(){ return m_pArrays->belowLabels[ m_iID ]; }
 
     /// This site is coupled with another one (for dimmer formation)
     inline void setCoupledSite(Site* s){ m_pCoupledSite = s; }
@@ -158,87 +192,48 @@ public:
     inline void removeCouple(){ m_pCoupledSite = nullptr; }
 
     /// Sets if this site is occupied by a species or not
-    inline void setOccupied( bool occupied ){ m_bIsOccupied = occupied; }
+    inline void setOccupied( bool occupied ){ m_pArrays->occupied[ m_iID ] = occupied; }
 
     /// Checks if this site is occupied by a species or not
-    inline bool isOccupied(){ return m_bIsOccupied; }
+    inline bool isOccupied(){ return m_pArrays->occupied[ m_iID ]; }
+
+    /// Points the neighbours of a site copied from another lattice to the sites of this lattice with the same IDs
+    /// and its state to the arrays of this lattice
+    void remapSites( const vector<Site*>& sites, SiteArrays* arrays );
 
 protected:
     //The lattice type that this site belongs to
     //LatticeType m_LatticeType;
 
-    /// The ID of the site.
+    /// The ID of the site (its position in the arrays of the lattice).
     int m_iID;
 
-    /// The height in the particular position.
-    int m_iHeight;
+    /// The arrays of the lattice that hold the state of the site.
+    SiteArrays* m_pArrays;
 
     /// The neighbours at the same level.
     vector< Site*> m_vNeigh;
 
-    /// Holds the number of the neighbours of the particular site according to each height/
-    int m_iNumNeighs;
-
-    /// A map that holds the neighbour sites according to their orientation.
-    map< NeighPoisition, Site*> m_mapNeigh;
-
-    /// A map that hold the sites that this site can activate if it has all the its neighbours occupied.
-    map< ActivationSite, Site* > m_mapAct;
-
-    /// A list of active sites for each process
-    map< Process*, vector<Site*>> activeSites;
-
-    /// A map counting the species that are present
-    map<int, int> m_mapSpecies;
-
-    /// To check if a site is occupied or not.
-    bool m_bIsOccupied;
-
-    /// The list of processes that this site can participate in.
-    list< Process* > m_lProcs;
-
-    bool m_phantom;
-
-    //Holds the number of the reactants species in this site.
-    // m_vReacSpecies has size the number of ALL reactants species
-    valarray< int > m_vReacSpecies;
-
-    /// The number of first neighs
-    int m_iFirstNeighs;
-
-    /// The number of second neighs
-    int m_iSecondNeighs;
-
-    /// The label of this site
-    string m_sLabel;
-
-    /// The label of the site below this site (in case of multiple species growth)
-    string m_sBelowLabel;
+    /// The neighbour sites according to their orientation (null if not set).
+    Site* m_aNeighPosition[ SOUTH + 1 ];
 
     /// Coupled site
     Site* m_pCoupledSite;
 
 private:
-    /// Orientation of the lattice
-    string m_sOrint;
-
-    /// The 1st neighbors in the different levels
+    /// The 1st neighbors in the different levels (only for the lattices that set them)
     /// below level
     /// same level
     /// upper level
     map< int, vector <Site* > > m_m1stNeighs;
 
-    /// The 2nd nearest neighbors in the different levels
-    /// below level
-    /// same level
-    /// upper level
-    map< int, vector <Site* > > m_m2ndNeighs;
-
-    /// if the site belong to the lower step storing vaious info
-    bool m_isLowerStep;
-
-    /// if the site belong to the higher step storing vaious info
-    bool m_isHigherStep;
+    /// Sets or clears a step flag of the site
+    inline void mf_setStepFlag( char flag, bool b ){
+        if ( b )
+            m_pArrays->stepFlags[ m_iID ] |= flag;
+        else
+            m_pArrays->stepFlags[ m_iID ] &= ~flag;
+    }
 };
 
 }
@@ -0,0 +1,117 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef SITE_ARRAYS_H
+#define SITE_ARRAYS_H
+
+#include <vector>
+
+using namespace std;
+
+namespace SurfaceTiles
+{
+
+class Site;
+
+/** The state of the lattice sites stored as structure of arrays indexed by the ID of the site.
+ * The sites (SurfaceTiles::Site) are handles to their entries so that the rules and the performs can work either
+ * on the sites or directly on the arrays without following pointers. The neighbours are stored in compressed sparse
+ * row format: the neighbours of site i are neighIndex[ neighStart[i] ] ... neighIndex[ neighStart[i + 1] - 1 ]
+ * (in the order they were set by the lattice). */
+
+struct SiteArrays
+{
+    /// The flags of the sites at the edge of a stepped surface (stepFlags)
+    enum StepFlag {
+        LOWER_STEP = 1,
+        HIGHER_STEP = 2
+    };
+
+    /// The height of each site
+    vector<int> heights;
+
+    /// The species of each site (its ID in the SpeciesRegistry)
+    vector<int> labels;
+
+    /// The species of the site below each site
+    vector<int> belowLabels;
+
+    /// The coordination of each site: the number of its neighbours at the same or a higher level (for PVD).
+    /// Computed by the lattice and kept up to date when the heights change (Lattice::updateCoordination).
+    vector<int> neighsNum;
+
+    /// True if the site is occupied by a species
+    vector<char> occupied;
+
+    /// The step flags of each site (StepFlag - set by the lattice when it builds the steps)
+    vector<char> stepFlags;
+
+    /// The start of the neighbours of each site in neighIndex (size: number of sites + 1)
+    vector<int> neighStart;
+
+    /// The IDs of the neighbours of all the sites
+    vector<int> neighIndex;
+
+    /// The height offset of each neighbour in the order of neighIndex: neighbour j of site i is at the same or a higher level
+    /// if heights[ j ] >= heights[ i ] + neighOffset[ k ]. Not zero only across the edge of a stepped surface (set with the steps).
+    vector<int> neighOffset;
+
+    /// The sites that have each site as neighbour in the same format (revIndex[ revStart[i] ] ... revIndex[ revStart[i + 1] - 1 ])
+    vector<int> revStart;
+    vector<int> revIndex;
+
+    /// Allocates the arrays for n sites
+    inline void resize( int n ){
+        heights.resize( n, 0 );
+        labels.resize( n, -1 );
+        belowLabels.resize( n, -1 );
+        neighsNum.resize( n, 0 );
+        occupied.resize( n, false );
+        stepFlags.resize( n, 0 );
+    }
+
+    /// Returns the number of sites
+    inline int size() const { return heights.size(); }
+
+    /// Builds the neighbour index and its reverse from the neighbours set to the sites
+    void buildNeighbourIndex( const vector<Site*>& sites );
+
+    /// Returns the position of the first neighbour of site i in neighIndex
+    inline int neighBegin( int i ) const { return neighStart[ i ]; }
+
+    /// Returns the position after the last neighbour of site i in neighIndex
+    inline int neighEnd( int i ) const { return neighStart[ i + 1 ]; }
+
+    /// Returns the coordination of site i computed from the heights: the number of its neighbours at the same or a higher level
+    inline int coordination( int i ) const {
+        int neighs = 0;
+        for ( int k = neighStart[ i ]; k < neighStart[ i + 1 ]; k++ )
+            neighs += heights[ neighIndex[ k ] ] >= heights[ i ] + neighOffset[ k ];
+
+        return neighs;
+    }
+
+    /// Returns the position of the first site that has site i as neighbour in revIndex
+    inline int revBegin( int i ) const { return revStart[ i ]; }
+
+    /// Returns the position after the last site that has site i as neighbour in revIndex
+    inline int revEnd( int i ) const { return revStart[ i + 1 ]; }
+};
+
+}
+
+#endif // SITE_ARRAYS_H
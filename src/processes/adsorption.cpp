@@ -22,7 +22,7 @@ namespace MicroProcesses
 
 REGISTER_PROCESS_IMPL( Adsorption )
 
-Adsorption::Adsorption(){}
+Adsorption::Adsorption():m_fBin(nullptr), m_iAdsorbed(SpeciesRegistry::NONE){}
 
 Adsorption::~Adsorption(){}
 
@@ -56,32 +56,57 @@ void Adsorption::init( vector<string> params )
     m_dRateConstant = (*m_fType)(this);
 
     //Create the rule for this adsoprtion process.
-    if ( m_iNumSites == 1 && isPartOfGrowth( m_sAdsorbed ) ){
+    //The state read by each rule and changed by each perform is kept for re-evaluating only the dependent rules after an event.
+    if ( m_iNumSites == 1 && isPartOfGrowth( m_iAdsorbed ) ){
         setUncoAccepted( true );
         m_fRules = &uncoRule;
+        m_iRuleReads = 0;
     }
-    else if ( m_iNumSites > 1 && isPartOfGrowth( m_sAdsorbed ) )
+    else if ( m_iNumSites > 1 && isPartOfGrowth( m_iAdsorbed ) ){
         m_fRules = &basicRule;
-    else if ( m_iNumSites == 1 && !isPartOfGrowth( m_sAdsorbed ) )
+        m_iRuleReads = HEIGHT | NEIGH_HEIGHT;
+    }
+    else if ( m_iNumSites == 1 && !isPartOfGrowth( m_iAdsorbed ) ){
         m_fRules = &multiSpeciesSimpleRule;
-    else if ( m_iNumSites > 1 && !isPartOfGrowth( m_sAdsorbed ) )
+        m_iRuleReads = OCCUPIED;
+    }
+    else if ( m_iNumSites > 1 && !isPartOfGrowth( m_iAdsorbed ) ){
         m_fRules = &multiSpeciesRule;
+        m_iRuleReads = OCCUPIED | HEIGHT | NEIGH_OCCUPIED | NEIGH_HEIGHT;
+    }
     else {
         m_error->error_simple_msg("The rule for this process has not been defined.");
         EXIT
     }
 
+    //With the keyword "all" the sites of the rule for more than one site are binned by their number of vacant neighbours
+    //and the rate constant of each bin is computed for this number
+    if ( m_iNumBins > 1 && m_fRules == &multiSpeciesRule )
+        m_fBin = &multiSpeciesBin;
+
+    int vacant = m_iNumVacant;
+    mf_buildRates( m_fBin != nullptr, [this]( int n ){ m_iNumVacant = n; return (*m_fType)(this); } );
+    m_iNumVacant = vacant;
+
     //Check what process should be performed.
     //Adsorption in PVD will lead to increasing the height of the site
     //Adsorption in CVD/ALD will only change the label of the site. The height will change from surface reaction.
-    if ( m_iNumSites == 1  && isPartOfGrowth(m_sAdsorbed) )
+    if ( m_iNumSites == 1  && isPartOfGrowth(m_iAdsorbed) ){
         m_fPerform = &signleSpeciesSimpleAdsorption;
-    else if ( m_iNumSites > 1  && isPartOfGrowth( m_sAdsorbed ) )
+        m_iPerformWrites = HEIGHT;
+    }
+    else if ( m_iNumSites > 1  && isPartOfGrowth( m_iAdsorbed ) ){
         m_fPerform = &signleSpeciesAdsorption;
-    else if ( m_iNumSites == 1 && !isPartOfGrowth(m_sAdsorbed) )
+        m_iPerformWrites = HEIGHT;
+    }
+    else if ( m_iNumSites == 1 && !isPartOfGrowth(m_iAdsorbed) ){
         m_fPerform = &multiSpeciesSimpleAdsorption;
-    else if ( m_iNumSites > 1 && !isPartOfGrowth(m_sAdsorbed) )
+        m_iPerformWrites = OCCUPIED | LABEL;
+    }
+    else if ( m_iNumSites > 1 && !isPartOfGrowth(m_iAdsorbed) ){
         m_fPerform = &multiSpeciesAdsorption;
+        m_iPerformWrites = OCCUPIED | LABEL;
+    }
     else {
         m_error->error_simple_msg("The process is not defined | " + m_sProcName );
         EXIT
@@ -89,9 +114,13 @@ void Adsorption::init( vector<string> params )
 }
 
 int Adsorption::countVacantSites( Site* s){
+    const SiteArrays& a = m_pLattice->getArrays();
+    int id = s->getID();
+
     int iCount = 0;
-    for (Site* neigh:s->getNeighs() ){
-        if ( !neigh->isOccupied() && s->getHeight() == neigh->getHeight() )
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ){
+        int neigh = a.neighIndex[ k ];
+        if ( !a.occupied[ neigh ] && a.heights[ id ] == a.heights[ neigh ] )
             iCount++;
     }
 
@@ -100,62 +129,33 @@ int Adsorption::countVacantSites( Site* s){
 
 bool Adsorption::rules( Site* s )
 {
-   return (*m_fRules)(this, s);
-}
+    if ( m_fBin )
+        return getBin( s ) >= 0;
 
-void Adsorption::perform( Site* s ) {
-
-    m_seAffectedSites.clear();
-    (*m_fPerform)(this, s);
+    return (*m_fRules)(this, s);
 }
 
-int Adsorption::calculateNeighbors(Site* s){
-
-    int neighs = 0;
-
-    if (m_pLattice->hasSteps() ){
-        for ( Site* neigh:s->getNeighs() ) {
-            if ( s->isLowerStep() && neigh->isHigherStep() ){
-                if ( neigh->getHeight() >= s->getHeight() + m_pLattice->getStepDiff() + 1 )
-                    neighs++;
-            }
-            else if ( neigh->isLowerStep() && s->isHigherStep() ){
-                if ( neigh->getHeight() >= s->getHeight() - m_pLattice->getStepDiff() + 1 )
-                    neighs++;
-            }
-            else {
-                if ( neigh->getHeight() >= s->getHeight() )
-                    neighs++;
-            }
-        }
-    } else {
-        int neighs = 0;
-        for ( Site* neigh:s->getNeighs() ) {
-            if ( neigh->getHeight() >= s->getHeight() )
-                neighs++;
-        }
-    }
+int Adsorption::getBin( Site* s )
+{
+    if ( !m_fBin )
+        return (*m_fRules)(this, s) ? 0 : -1;
 
-    s->setNeighsNum( neighs );
-    return neighs;
+    int bin = (*m_fBin)(this, s);
+    return bin < getNumBins() ? bin : -1;
 }
 
-bool Adsorption::isInLowerStep(Site* s) {
-
-    for (int j = 0; j < m_pLattice->getY(); j++)
-        if ( s->getID() == m_pLattice->getSite( j, 0 )->getID() )
-            return true;
+string Adsorption::getBinName( int bin )
+{
+    if ( !m_fBin )
+        return "";
 
-    return false;
+    return " (" + to_string( bin ) + " V)";
 }
 
-bool Adsorption::isInHigherStep(Site* s){
-
-    for (int j = 0; j < m_pLattice->getY(); j++)
-        if ( s->getID() == m_pLattice->getSite( j, m_pLattice->getX() - 1 )->getID() )
-            return true;
+void Adsorption::perform( Site* s, AffectedSites& affected ) {
 
-    return false;
+    affected.clear();
+    (*m_fPerform)(this, s, affected);
 }
 
 }
@@ -33,11 +33,14 @@ public:
     ~Adsorption() override;
 
     bool rules( Site* ) override;
-    void perform( Site* ) override;
+    int getBin( Site* s ) override;
+    string getBinName( int bin ) override;
+    void perform( Site*, AffectedSites& affected ) override;
+    Process* clone() override { return new Adsorption( *this ); }
     void init( vector<string> params ) override;
 
     /// Sets the specific adsorption species label according to the input
-    void setAdrorbed(string adsorbed){ m_sAdsorbed = adsorbed;}
+    void setAdrorbed(string adsorbed){ m_iAdsorbed = SpeciesRegistry::intern( adsorbed );}
 
     /// Set the number of sites that this adsorbed occupies.
     inline void setNumSites( int i ) { m_iNumSites = i;}
@@ -63,30 +66,22 @@ public:
     /// Get the adsorption rate given as input from the user with the constant keyword
     inline double getAdsorptionRate() { return m_dAdsorptionRate; }
 
-    /// Calculates the neighbors of a given site - To be transerred to process?
-    int calculateNeighbors(Site*);
-
     /// Counts the vacants sites - To be transerred to process?
     int countVacantSites( Site* s);
 
-    /// Returns the label of the adsorbed species
-    inline string getAdsorbedSpecies() { return m_sAdsorbed; }
+    /// Returns the ID of the adsorbed species
+    inline int getAdsorbedSpecies() { return m_iAdsorbed; }
 
 protected: //pointers to functions
 
     /// Pointers to functions in order to switch between different functionalities
     double (*m_fType)(Adsorption*);
     bool (*m_fRules)(Adsorption*, Site*);
-    void (*m_fPerform)(Adsorption*, Site*);
+    int (*m_fBin)(Adsorption*, Site*);
+    void (*m_fPerform)(Adsorption*, Site*, AffectedSites&);
 
 private: //data
 
-    /// Checks if the site is in lower step (only for simple cubic lattice)
-    bool isInLowerStep( Site* s );
-
-    /// Checks if the site is in higher step (only for simple cubic lattice)
-    bool isInHigherStep( Site* s );
-
     /// For simple adsorption:
     ///The sticking coefficient [-]
     double m_dStick;
@@ -101,7 +96,7 @@ private: //data
     double m_dMW;
 
     /// The species to be asdorbed
-    string m_sAdsorbed;
+    int m_iAdsorbed;
 
     /// The adsorption rate given as input from the user with the constant keyword
     double m_dAdsorptionRate;
@@ -3,90 +3,100 @@
 namespace MicroProcesses
 {
 
-void signleSpeciesAdsorption(Adsorption* proc, Site *s) {
-    //Needs check!
-    s->increaseHeight( 1 );
-    proc->calculateNeighbors( s );
-    proc->addAffectedSite( s ) ;
+//The performs change the state of the sites in the arrays of the lattice
+void signleSpeciesAdsorption(Adsorption* proc, Site *s, AffectedSites& affected ) {
+    Lattice* lattice = proc->getLattice();
+    SiteArrays& a = lattice->getArrays();
+    const vector<Site*>& sites = lattice->getSites();
+    int id = s->getID();
 
-    for ( Site* neigh:s->getNeighs() ) {
-        proc->calculateNeighbors( neigh );
-        proc->addAffectedSite( neigh );
-    }
+    //Needs check!
+    a.heights[ id ]++;
+    lattice->updateCoordination( id );
+    affected.add( sites, id );
+    affected.addNeighs( a, sites, id );
 
-    vector<Site*> neighs = s->getNeighs();
+    //The candidates are removed once picked (the buffer is kept between the events so that nothing is allocated)
+    static thread_local vector<int> neighs;
+    neighs.assign( a.neighIndex.begin() + a.neighBegin( id ), a.neighIndex.begin() + a.neighEnd( id ) );
 
     // Because one is already occupied above
     for ( int i = 0 ; i < proc->getNumSites()-1; i++) {
         int ranNum = proc->getRandomGen()->getIntRandom( 0,  neighs.size()-1 );
-        Site* neigh = neighs[ ranNum ];
-        neigh->increaseHeight(1);
-        proc->calculateNeighbors( neigh );
-        proc->addAffectedSite( neigh );
-
-        for ( Site* neigh2:neigh->getNeighs() ) {
-            proc->calculateNeighbors( neigh2 );
-            proc->addAffectedSite( neigh2 );
-        }
+        int neigh = neighs[ ranNum ];
+        a.heights[ neigh ]++;
+        lattice->updateCoordination( neigh );
+        affected.add( sites, neigh );
+        affected.addNeighs( a, sites, neigh );
 
-        neighs.erase( find( neighs.begin(), neighs.end(), neigh ) );
+        neighs.erase( neighs.begin() + ranNum );
     }
 }
 
-void signleSpeciesSimpleAdsorption(Adsorption* proc, Site *s) {
-    s->increaseHeight( 1 );
-    proc->calculateNeighbors( s );
-    proc->addAffectedSite( s ) ;
+void signleSpeciesSimpleAdsorption(Adsorption* proc, Site *s, AffectedSites& affected ) {
+    Lattice* lattice = proc->getLattice();
+    SiteArrays& a = lattice->getArrays();
+    const vector<Site*>& sites = lattice->getSites();
+    int id = s->getID();
 
-    for ( Site* neigh:s->getNeighs() ) {
-        proc->calculateNeighbors( neigh );
-        proc->addAffectedSite( neigh );
-    }
+    a.heights[ id ]++;
+    lattice->updateCoordination( id );
+    affected.add( sites, id );
+    affected.addNeighs( a, sites, id );
 }
 
-void multiSpeciesSimpleAdsorption(Adsorption* proc, Site *s) {
+void multiSpeciesSimpleAdsorption(Adsorption* proc, Site *s, AffectedSites& affected ) {
+    Lattice* lattice = proc->getLattice();
+    SiteArrays& a = lattice->getArrays();
+    const vector<Site*>& sites = lattice->getSites();
+    int id = s->getID();
+
     //Here must hold the previous site in order to appear in case of multiple species forming the growing film
-    s->setOccupied( true );
-    s->setBelowLabel( s->getLabel() );
-    s->setLabel( proc->getAdsorbedSpecies() );
+    a.occupied[ id ] = true;
+    a.belowLabels[ id ] = a.labels[ id ];
+    a.labels[ id ] = proc->getAdsorbedSpecies();
 
-    proc->addAffectedSite( s ) ;
-    for ( Site* neigh:s->getNeighs() )
-        proc->addAffectedSite( neigh ) ;
+    affected.add( sites, id );
+    affected.addNeighs( a, sites, id );
 }
 
-void multiSpeciesAdsorption(Adsorption* proc, Site *s) {
+void multiSpeciesAdsorption(Adsorption* proc, Site *s, AffectedSites& affected ) {
+    Lattice* lattice = proc->getLattice();
+    SiteArrays& a = lattice->getArrays();
+    const vector<Site*>& sites = lattice->getSites();
+    int id = s->getID();
+
     //Here must hold the previous site in order to appear in case of multiple species forming the growing film
-    s->setOccupied( true );
-    s->setBelowLabel( s->getLabel() );
-    s->setLabel( proc->getAdsorbedSpecies() );
+    a.occupied[ id ] = true;
+    a.belowLabels[ id ] = a.labels[ id ];
+    a.labels[ id ] = proc->getAdsorbedSpecies();
 
-    proc->addAffectedSite( s ) ;
-    for ( Site* neigh:s->getNeighs() )
-        proc->addAffectedSite( neigh ) ;
+    affected.add( sites, id );
+    affected.addNeighs( a, sites, id );
 
-    vector<Site*> neighs = s->getNeighs();
+    //The candidates are removed once picked (the buffer is kept between the events so that nothing is allocated)
+    static thread_local vector<int> neighs;
+    neighs.assign( a.neighIndex.begin() + a.neighBegin( id ), a.neighIndex.begin() + a.neighEnd( id ) );
 
     int iNum = 0;
     while (iNum != proc->getNumSites()-1 ) {
         int ranNum = proc->getRandomGen()->getIntRandom( 0,  neighs.size()-1 );
 
-        Site* neigh = neighs[ ranNum ];
+        int neigh = neighs[ ranNum ];
 
-        if ( !neigh->isOccupied() && neigh->getHeight() == s->getHeight() ) {
-            neigh->setOccupied( true );
-            neigh->setBelowLabel( neigh->getLabel() );
-            neigh->setLabel( proc->getAdsorbedSpecies() );
+        if ( !a.occupied[ neigh ] && a.heights[ neigh ] == a.heights[ id ] ) {
+            a.occupied[ neigh ] = true;
+            a.belowLabels[ neigh ] = a.labels[ neigh ];
+            a.labels[ neigh ] = proc->getAdsorbedSpecies();
 
-            proc->addAffectedSite( neigh ) ;
-            for ( Site* neigh2:neigh->getNeighs() )
-               proc->addAffectedSite( neigh2 );
+            affected.add( sites, neigh );
+            affected.addNeighs( a, sites, neigh );
 
-            neighs.erase( find( neighs.begin(), neighs.end(), neigh ) );
+            neighs.erase( neighs.begin() + ranNum );
             iNum++;
         }
         else
-            neighs.erase( find( neighs.begin(), neighs.end(), neigh ) );
+            neighs.erase( neighs.begin() + ranNum );
     }
 }
 
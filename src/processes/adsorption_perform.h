@@ -3,21 +3,22 @@
 
 #include "adsorption.h"
 #include "site.h"
+#include "affected_sites.h"
 
 namespace MicroProcesses
 {
 
 /// The process is PVD
-void signleSpeciesSimpleAdsorption(Adsorption*, Site* );
+void signleSpeciesSimpleAdsorption(Adsorption*, Site*, AffectedSites&);
 
 /// The process is PVD for multiple sites
-void signleSpeciesAdsorption(Adsorption*, Site*);
+void signleSpeciesAdsorption(Adsorption*, Site*, AffectedSites&);
 
 /// The process is CVD or ALD
-void multiSpeciesSimpleAdsorption(Adsorption*, Site*);
+void multiSpeciesSimpleAdsorption(Adsorption*, Site*, AffectedSites&);
 
 /// The process is CVD or ALD for multiple sites
-void multiSpeciesAdsorption(Adsorption*, Site*);
+void multiSpeciesAdsorption(Adsorption*, Site*, AffectedSites&);
 
 }
 
@@ -5,10 +5,10 @@ namespace MicroProcesses
 
 bool uncoRule(Adsorption*, Site*) { return true; }
 
-
+//The rules read the state of the sites from the arrays of the lattice
 bool basicRule(Adsorption* proc, Site* s){
 
-    if ( proc->calculateNeighbors(s) == proc->getNumSites() )
+    if ( proc->getLattice()->getArrays().neighsNum[ s->getID() ] == proc->getNumSites() )
         return true;
 
     return false;
@@ -17,7 +17,7 @@ bool basicRule(Adsorption* proc, Site* s){
 bool multiSpeciesSimpleRule(Adsorption* proc, Site* s){
     //1. If the species is not occupied return true
     //2. Return false
-    if ( !s->isOccupied() )
+    if ( !proc->getLattice()->getArrays().occupied[ s->getID() ] )
         return true;
 
     return false;
@@ -29,10 +29,14 @@ bool multiSpeciesRule(Adsorption* proc, Site* s){
     //2. and if neighbours equal to the sites needed by m_iNumSites are vacant
     //3. and have the same height return true (checked inside countVacantSites)
     //4. Return false
-    if ( s->isOccupied() || proc->countVacantSites(s) != proc->getNumVacantSites() )
-        return false;
+    return multiSpeciesBin( proc, s ) == proc->getNumVacantSites();
+}
+
+int multiSpeciesBin(Adsorption* proc, Site* s){
+    if ( proc->getLattice()->getArrays().occupied[ s->getID() ] )
+        return -1;
 
-    return true;
+    return proc->countVacantSites(s);
 }
 
 }
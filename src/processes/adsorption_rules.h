@@ -20,6 +20,9 @@ bool multiSpeciesSimpleRule(Adsorption*,  Site*);
 /// For adsorbing different species the sites must not be occupied (and TODO: the height must be the same)
 bool multiSpeciesRule(Adsorption*,  Site*);
 
+/// The bin of a site with the keyword "all": the number of its vacant neighbours at the same height (-1 if it is occupied)
+int multiSpeciesBin(Adsorption*,  Site*);
+
 }
 
 #endif // ADSORPTION_RULES_H
@@ -0,0 +1,93 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+#ifndef AFFECTED_SITES_H
+#define AFFECTED_SITES_H
+
+#include <vector>
+
+#include "site.h"
+
+using namespace std;
+
+namespace MicroProcesses
+{
+
+/** The sites affected by a perform (the site where it is performed and the sites around it whose rules may change).
+ * It is filled by the perform and read by the engine, which owns it and reuses it for every event.
+ * A site is added once: the epoch of the last fill is stamped on the site (by its ID) when it is added, so adding
+ * is O(1) and clearing does not touch the stamps. The sites are kept in the order they were added. */
+class AffectedSites
+{
+public:
+    AffectedSites():m_iEpoch(1){}
+
+    /// Starts a new fill (used by the perform before adding the sites)
+    inline void clear(){
+        m_vSites.clear();
+
+        //The stamps are reset when the epoch wraps around so that an old stamp is never taken for the current one
+        if ( ++m_iEpoch == 0 ){
+            m_vStamp.assign( m_vStamp.size(), 0 );
+            m_iEpoch = 1;
+        }
+    }
+
+    /// Adds the site if it was not added since the last clear
+    inline void add( Site* s ){ add( s->getID(), s ); }
+
+    /// Adds the site with the given ID and handle (the site is not read)
+    inline void add( int id, Site* s ){
+        if ( id >= (int)m_vStamp.size() )
+            m_vStamp.resize( id + 1, 0 );
+
+        if ( m_vStamp[ id ] != m_iEpoch ){
+            m_vStamp[ id ] = m_iEpoch;
+            m_vSites.push_back( s );
+        }
+    }
+
+    /// Adds the site id of the lattice (sites are the handles of the lattice sites by ID)
+    inline void add( const vector<Site*>& sites, int id ){ add( id, sites[ id ] ); }
+
+    /// Adds the neighbours of the site id of the lattice from the neighbour index of its arrays
+    inline void addNeighs( const SiteArrays& a, const vector<Site*>& sites, int id ){
+        for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ )
+            add( a.neighIndex[ k ], sites[ a.neighIndex[ k ] ] );
+    }
+
+    /// Returns the number of the affected sites
+    inline int size() const { return m_vSites.size(); }
+
+    inline vector<Site*>::const_iterator begin() const { return m_vSites.begin(); }
+    inline vector<Site*>::const_iterator end() const { return m_vSites.end(); }
+
+private:
+    /// The affected sites in the order they were added
+    vector<Site*> m_vSites;
+
+    /// The epoch at which each site (by ID) was last added
+    vector<unsigned int> m_vStamp;
+
+    /// The current epoch (never 0)
+    unsigned int m_iEpoch;
+};
+
+}
+
+#endif // AFFECTED_SITES_H
@@ -22,7 +22,7 @@ namespace MicroProcesses
 
 REGISTER_PROCESS_IMPL(Desorption);
 
-Desorption::Desorption():m_bAllNeihs(false){}
+Desorption::Desorption():m_fBin(nullptr), m_iDesorbed(SpeciesRegistry::NONE){}
 Desorption::~Desorption(){}
 
 void Desorption::init(vector<string> params)
@@ -53,84 +53,69 @@ void Desorption::init(vector<string> params)
     m_dRateConstant = (*m_fType)(this);
 
     //Create the rule for the adsoprtion process.
-    if ( m_bAllNeihs && isPartOfGrowth( m_sDesorbed ) )
-        m_fRules = &allRule;
-    else if ( !m_bAllNeihs &&  isPartOfGrowth( m_sDesorbed ) )
+    //The state read by each rule and changed by each perform is kept for re-evaluating only the dependent rules after an event.
+    //With the keyword "all" (more than one bin) the sites of the growing film are binned by their number of neighbours.
+    if ( m_iNumBins > 1 && isPartOfGrowth( m_iDesorbed ) ){
+        m_fRules = nullptr;
+        m_fBin = &allBin;
+        m_iRuleReads = HEIGHT | NEIGH_HEIGHT;
+    }
+    else if ( isPartOfGrowth( m_iDesorbed ) ){
         m_fRules = &basicRule;
-    else
+        m_iRuleReads = 0;
+    }
+    else {
         m_fRules = &difSpeciesRule;
+        m_iRuleReads = OCCUPIED;
+    }
+
+    //The rate constant of each bin is computed for its number of neighbours
+    int neighs = m_iNumNeighs;
+    mf_buildRates( m_fBin != nullptr, [this]( int n ){ m_iNumNeighs = n; return (*m_fType)(this); } );
+    m_iNumNeighs = neighs;
 
     //Check what process should be performed.
     //Desorption in PVD will lead to increasing the height of the site
     //Desorption in CVD/ALD will only change the label of the site
-    if ( isPartOfGrowth( m_sDesorbed ) )
+    if ( isPartOfGrowth( m_iDesorbed ) ){
         m_fPerform = &singleSpeciesSimpleDesorption;
-    else
+        m_iPerformWrites = HEIGHT;
+    }
+    else {
         m_fPerform = &multiSpeciesSimpleDesorption;
+        m_iPerformWrites = OCCUPIED | LABEL;
+    }
 }
 
 bool Desorption::rules( Site* s)
 {
-    return (*m_fRules)(this, s);
-}
+    if ( m_fBin )
+        return getBin( s ) >= 0;
 
-void Desorption::perform( Site* s)
-{
-    m_seAffectedSites.clear();
-    (*m_fPerform)(this, s);
+    return (*m_fRules)(this, s);
 }
 
-int Desorption::calculateNeighbors(Site* s)
+int Desorption::getBin( Site* s )
 {
-    int neighs = 0;
-
-    if ( m_pLattice->hasSteps() ){
-        for ( Site* neigh:s->getNeighs() ) {
-            if ( s->isLowerStep() && neigh->isHigherStep() ){
-                if ( neigh->getHeight() >= s->getHeight() + m_pLattice->getStepDiff() + 1 )
-                    neighs++;
-            }
-            else if ( neigh->isLowerStep() && s->isHigherStep() ){
-                if ( neigh->getHeight() >= s->getHeight() - m_pLattice->getStepDiff() + 1 )
-                    neighs++;
-            }
-            else {
-                if ( neigh->getHeight() >= s->getHeight() )
-                    neighs++;
-            }
-        }
-
-        s->setNeighsNum( neighs );
-    }
-    else {
-        for ( Site* neigh:s->getNeighs() ) {
-            if ( neigh->getHeight() >= s->getHeight() )
-                neighs++;
-        }
+    if ( !m_fBin )
+        return (*m_fRules)(this, s) ? 0 : -1;
 
-        s->setNeighsNum( neighs );
-    }
-
-    return neighs;
+    int bin = (*m_fBin)(this, s);
+    return bin < getNumBins() ? bin : -1;
 }
 
-bool Desorption::isInLowerStep(Site* s)
+string Desorption::getBinName( int bin )
 {
-    for (int j = 0; j < m_pLattice->getY(); j++)
-        if ( s->getID() == m_pLattice->getSite( j, 0 )->getID() )
-            return true;
+    if ( !m_fBin )
+        return "";
 
-    return false;
+    return " (" + to_string( bin + 1 ) + " N)";
 }
 
-bool Desorption::isInHigherStep(Site* s)
+void Desorption::perform( Site* s, AffectedSites& affected )
 {
-    for (int j = 0; j < m_pLattice->getY(); j++){
-        if ( s->getID() == m_pLattice->getSite( j, m_pLattice->getX() - 1 )->getID() )
-            return true;
-    }
-
-    return false;
+    affected.clear();
+    (*m_fPerform)(this, s, affected);
 }
 
 }
@@ -33,17 +33,14 @@ public:
     ~Desorption() override;
 
     bool rules( Site* s) override;
-    void perform( Site* ) override;
+    int getBin( Site* s ) override;
+    string getBinName( int bin ) override;
+    void perform( Site*, AffectedSites& affected ) override;
+    Process* clone() override { return new Desorption( *this ); }
     void init(vector<string> params) override;
 
     /// Sets the specific adsorption species label according to the input
-    void setDesorbed(string desorbed){ m_sDesorbed = desorbed;}
-
-    /// If keyrowd "all" is added then this is true
-    inline void setAllNeighs( bool all ){  m_bAllNeihs = all; }
-
-    /// A member function to calculate the neighbors of a given site
-    int calculateNeighbors(Site*);
+    void setDesorbed(string desorbed){ m_iDesorbed = SpeciesRegistry::intern( desorbed );}
 
     /// The rate of desorption if contant type
     double getDesorptionRate() { return m_dDesorptionRate;}
@@ -54,30 +51,22 @@ public:
     /// Returns the vibrational frequency if Arrhenius type
     double getVibrationalFrequency() {return m_dv0; }
 
-    /// The number of neighbors defined for this process
-    double getNumNeighs(){ return m_iNumNeighs; }
-
 
 protected: //pointers to functions
 
     /// Pointers to functions in order to switch between different functionalities
     double (*m_fType)(Desorption*);
     bool (*m_fRules)(Desorption*, Site*);
-    void (*m_fPerform)(Desorption*, Site*);
+    int (*m_fBin)(Desorption*, Site*);
+    void (*m_fPerform)(Desorption*, Site*, AffectedSites&);
 
 private: //the data
 
     ///The site that adsorption will be performed
     Site* m_Site;
 
-    /// The number of neighbours of this process
-    int m_iNumNeighs;
-
     /// The species to be asdorbed
-    string m_sDesorbed;
-
-    /// If the user has "all" keyword this is set to true
-    bool m_bAllNeihs;
+    int m_iDesorbed;
 
     /// The desorption rate given as input from the user with the constant keyword
     double m_dDesorptionRate;
@@ -88,12 +77,6 @@ private: //the data
     /// The activation energy of the process (if arrhenius)
     double m_dEd;
 
-    /// Checks if the site is in lower step (only for simple cubic lattice)
-    bool isInLowerStep( Site* s );
-
-    /// Checks if the site is in higher step (only for simple cubic lattice)
-    bool isInHigherStep( Site* s );
-
     REGISTER_PROCESS(Desorption)
 };
 }
@@ -3,30 +3,35 @@
 namespace MicroProcesses
 {
 
-void singleSpeciesSimpleDesorption(Desorption* proc, Site *s) {
-    //For PVD results
-    s->decreaseHeight( 1 );
-    proc->calculateNeighbors( s ) ;
-    proc->addAffectedSite( s );
-    for ( Site* neigh:s->getNeighs() ) {
-        proc->calculateNeighbors( neigh );
-        proc->addAffectedSite( neigh );
+//The performs change the state of the sites in the arrays of the lattice
+void singleSpeciesSimpleDesorption(Desorption* proc, Site *s, AffectedSites& affected ) {
+    Lattice* lattice = proc->getLattice();
+    SiteArrays& a = lattice->getArrays();
+    const vector<Site*>& sites = lattice->getSites();
+    int id = s->getID();
 
-        for ( Site* firstNeigh:neigh->getNeighs() ){
-            firstNeigh->setNeighsNum( proc->calculateNeighbors( firstNeigh ) );
-            proc->addAffectedSite( firstNeigh );
-        }
+    //For PVD results
+    a.heights[ id ]--;
+    lattice->updateCoordination( id );
+    affected.add( sites, id );
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ) {
+        affected.add( sites, a.neighIndex[ k ] );
+        affected.addNeighs( a, sites, a.neighIndex[ k ] );
     }
 }
 
-void multiSpeciesSimpleDesorption(Desorption* proc, Site *s)
+void multiSpeciesSimpleDesorption(Desorption* proc, Site *s, AffectedSites& affected )
 {
-    s->setOccupied( false );
-    s->setLabel( s->getBelowLabel() );
+    Lattice* lattice = proc->getLattice();
+    SiteArrays& a = lattice->getArrays();
+    const vector<Site*>& sites = lattice->getSites();
+    int id = s->getID();
+
+    a.occupied[ id ] = false;
+    a.labels[ id ] = a.belowLabels[ id ];
 
-    proc->addAffectedSite( s );
-    for ( Site* neigh:s->getNeighs() )
-        proc->addAffectedSite( neigh );
+    affected.add( sites, id );
+    affected.addNeighs( a, sites, id );
 }
 
 }
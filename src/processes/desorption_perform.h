@@ -3,15 +3,16 @@
 
 #include "desorption.h"
 #include "site.h"
+#include "affected_sites.h"
 
 namespace MicroProcesses
 {
 
 /// The process is PVD
-void singleSpeciesSimpleDesorption(Desorption*, Site*);
+void singleSpeciesSimpleDesorption(Desorption*, Site*, AffectedSites&);
 
 /// The process is CVD or ALD
-void multiSpeciesSimpleDesorption(Desorption*, Site*);
+void multiSpeciesSimpleDesorption(Desorption*, Site*, AffectedSites&);
 
 }
 
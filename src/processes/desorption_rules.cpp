@@ -3,10 +3,9 @@
 namespace MicroProcesses
 {
 
-bool allRule(Desorption* proc, Site* s){
-    if ( proc->calculateNeighbors( s ) == proc->getNumNeighs() )
-        return true;
-    return false;
+//The rules read the state of the sites from the arrays of the lattice
+int allBin(Desorption* proc, Site* s){
+    return proc->getLattice()->getArrays().neighsNum[ s->getID() ];
 }
 
 // This apply for every lattice without a rule which is actually just pick a site and apply it
@@ -19,7 +18,7 @@ bool difSpeciesRule(Desorption* proc, Site* s){
     //1. Calculate if there are sitess at the same height and not oocupied - their number is defined by stoichiometry of the adsorption reaction
     //2. If 1 holds then return true
     //1. Return false
-    if ( s->isOccupied() )
+    if ( proc->getLattice()->getArrays().occupied[ s->getID() ] )
         return true;
 
     return false;
@@ -7,8 +7,8 @@
 namespace MicroProcesses
 {
 
-/// If the keyword 'all' is used then the rule is based on the neighbours
-bool allRule(Desorption*, Site* s);
+/// If the keyword 'all' is used then the site is binned by its number of neighbours
+int allBin(Desorption*, Site* s);
 
 /// Returns always true - this is actually as having uncoditional acceptance
 bool basicRule(Desorption*, Site* s);
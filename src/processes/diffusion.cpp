@@ -22,7 +22,7 @@ namespace MicroProcesses
 
 REGISTER_PROCESS_IMPL(Diffusion)
 
-Diffusion::Diffusion(){}
+Diffusion::Diffusion():m_fBin(nullptr), m_iDiffused(SpeciesRegistry::NONE){}
 Diffusion::~Diffusion(){}
 
 
@@ -35,10 +35,9 @@ void Diffusion::init(vector<string> params)
     m_sType = any_cast<string>(m_vParams[ 0 ]);
     if ( m_sType.compare("arrhenius") == 0 ){
 
-        m_dv0 = stod(m_vParams[ 0 ]);
-        m_dEd = stod(m_vParams[ 1 ]);
-        m_dEdm = stod(m_vParams[ 2 ]);
-        m_iNumNeighs = stoi( m_vParams[3] );
+        m_dv0 = stod(m_vParams[ 1 ]);
+        m_dEd = stod(m_vParams[ 2 ]);
+        m_dEdm = stod(m_vParams[ 3 ]);
 
         m_fType = &arrheniusType;
     }
@@ -55,112 +54,98 @@ void Diffusion::init(vector<string> params)
     //Assign the type
     m_dRateConstant = (*m_fType)(this);
 
-    m_isPartOfGrowth = isPartOfGrowth( m_sDiffused );
+    m_isPartOfGrowth = isPartOfGrowth( m_iDiffused );
 
     //Select the rule for the diffusion process here
+    //The state read by each rule and changed by each perform is kept for re-evaluating only the dependent rules after an event.
+    //With the keyword "all" (more than one bin) the sites are binned by their number of vacant neighbours.
     if ( !m_isPartOfGrowth )
-        if ( !m_bAllNeihs )
+        if ( m_iNumBins == 1 )
             m_fRules = &diffusionBasicRule;
         else
-            m_fRules = &diffusionBasicAllRule;
-    else
+            m_fBin = &diffusionBasicAllBin;
+    else if ( m_iNumBins == 1 )
         m_fRules = &diffusionAllRule;
+    else
+        m_fBin = &diffusionAllBin;
+
+    m_iRuleReads = OCCUPIED | LABEL | HEIGHT | NEIGH_OCCUPIED | NEIGH_HEIGHT;
 
     //Check what process should be performed.
     //Desorption in PVD will lead to increasing the height of the site
     //Desorption in CVD will change the label of the site
-    if ( !m_isPartOfGrowth )
+    if ( !m_isPartOfGrowth ){
         m_fPerform = &simpleDiffusion;
-    else
+        m_iPerformWrites = OCCUPIED | LABEL;
+    }
+    else {
         m_fPerform = &performPVD;
+        m_iPerformWrites = HEIGHT;
+    }
+
+    //The rate constant of each bin is computed for its number of vacant neighbours
+    int vacant = m_iNumVacant, neighs = m_iNumNeighs;
+    mf_buildRates( m_fBin != nullptr, [this]( int n ){ m_iNumVacant = m_iNumNeighs = n; return (*m_fType)(this); } );
+    m_iNumVacant = vacant;
+    m_iNumNeighs = neighs;
 }
 
 bool Diffusion::rules( Site* s)
 {
+    if ( m_fBin )
+        return getBin( s ) >= 0;
+
     return (*m_fRules)(this, s);
 }
 
-void Diffusion::perform( Site* s)
+int Diffusion::getBin( Site* s )
 {
-    m_seAffectedSites.clear();
-    (*m_fPerform)(this, s);
-}
+    if ( !m_fBin )
+        return (*m_fRules)(this, s) ? 0 : -1;
 
-int Diffusion::calculateSameNeighbors(Site* s){
-    int neighs = 0;
-    for ( Site* neigh:s->getNeighs() ) {
-        if ( neigh->getLabel().compare(s->getLabel() ) == 0)
-            neighs++;
-    }
+    int bin = (*m_fBin)(this, s);
+    return bin < getNumBins() ? bin : -1;
 }
 
-int Diffusion::countVacantSites( Site* s){
-    int iCount = 0;
-    for (Site* neigh:s->getNeighs() ){
-        if ( !neigh->isOccupied() && s->getHeight() == neigh->getHeight() )
-            iCount++;
-    }
+string Diffusion::getBinName( int bin )
+{
+    if ( !m_fBin )
+        return "";
 
-    return iCount;
+    return " (" + to_string( bin ) + " V)";
 }
 
-int Diffusion::calculateNeighbors(Site* s)
+void Diffusion::perform( Site* s, AffectedSites& affected )
 {
-    int neighs = 0;
+    affected.clear();
+    (*m_fPerform)(this, s, affected);
+}
 
-    if ( m_isPartOfGrowth ) {
-        //If the particle of the lattice diffuses
-        if ( m_pLattice->hasSteps() ){
-            for ( Site* neigh:s->getNeighs() ) {
-                if ( s->isLowerStep() && neigh->isHigherStep() ){
-                    if ( neigh->getHeight() >= s->getHeight() + m_pLattice->getStepDiff() + 1 )
-                        neighs++;
-                }
-                else if ( neigh->isLowerStep() && s->isHigherStep() ){
-                    if ( neigh->getHeight() >= s->getHeight() - m_pLattice->getStepDiff() + 1 )
-                        neighs++;
-                }
-                else {
-                    if ( neigh->getHeight() >= s->getHeight() )
-                        neighs++;
-                }
-            }
-        }
-        else {
-            for ( Site* neigh:s->getNeighs() ) {
-                if ( neigh->getHeight() >= s->getHeight() )
-                    neighs++;
-            }
-        }
-    } else {
-        for ( Site* neigh:s->getNeighs() ) {
-            if ( !neigh->isOccupied()  )
-                neighs++;
-        }
+int Diffusion::calculateSameNeighbors(Site* s){
+    const SiteArrays& a = m_pLattice->getArrays();
+    int id = s->getID();
+
+    int neighs = 0;
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ) {
+        if ( a.labels[ a.neighIndex[ k ] ] == a.labels[ id ] )
+            neighs++;
     }
 
-    s->setNeighsNum( neighs );
     return neighs;
 }
 
-bool Diffusion::mf_isInLowerStep(Site* s)
-{
-    for (int j = 0; j < m_pLattice->getY(); j++)
-        if ( s->getID() == m_pLattice->getSite( j, 0 )->getID() )
-            return true;
-
-    return false;
-}
+int Diffusion::countVacantSites( Site* s){
+    const SiteArrays& a = m_pLattice->getArrays();
+    int id = s->getID();
 
-bool Diffusion::mf_isInHigherStep(Site* s)
-{
-    for (int j = 0; j < m_pLattice->getY(); j++){
-        if ( s->getID() == m_pLattice->getSite( j, m_pLattice->getX() - 1 )->getID() ){
-            return true;
-        }
+    int iCount = 0;
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ){
+        int neigh = a.neighIndex[ k ];
+        if ( !a.occupied[ neigh ] && a.heights[ id ] == a.heights[ neigh ] )
+            iCount++;
     }
 
-    return false;
+    return iCount;
 }
 
 }
@@ -38,19 +38,17 @@ public:
     ~Diffusion() override;
 
     bool rules( Site* ) override;
-    void perform( Site* ) override;
+    int getBin( Site* s ) override;
+    string getBinName( int bin ) override;
+    void perform( Site*, AffectedSites& affected ) override;
+    Process* clone() override { return new Diffusion( *this ); }
     void init(vector<string> params) override;
 
     /// Sets the specific diffusion species label according to the input
-    void setDiffused(string diffused){ m_sDiffused = diffused;}
+    void setDiffused(string diffused){ m_iDiffused = SpeciesRegistry::intern( diffused );}
 
-    string getDiffused(){ return m_sDiffused;}
-
-    /// If keyrowd "all" is added then this is true
-    inline void setAllNeighs( bool all ){  m_bAllNeihs = all; }
-
-    /// A member function to calculate the neighbors of a given site
-    int calculateNeighbors(Site*);
+    /// Returns the ID of the diffused species
+    int getDiffused(){ return m_iDiffused;}
 
     /// Returns the diffusion rate
     inline double getDiffusionRate() { return m_dDiffusionRate; }
@@ -73,25 +71,20 @@ protected:
     /// Pointers to functions in order to switch between different functions
     double (*m_fType)( Diffusion* );
     bool (*m_fRules)(Diffusion*, Site*);
-    void (*m_fPerform)(Diffusion*, Site*);
+    int (*m_fBin)(Diffusion*, Site*);
+    void (*m_fPerform)(Diffusion*, Site*, AffectedSites&);
 
 private:
 
-    bool mf_isInLowerStep( Site* s );
-    bool mf_isInHigherStep( Site* s );
-
     /// If the keyword 'all' is used then the rule is based on the neighbours
     bool mf_allRule(Site* s);
 
     /// The label of the diffused species
-    string m_sDiffused;
+    int m_iDiffused;
 
     /// True if the species that is to be diffused belongs to the growing film. Else it is false;
     bool m_isPartOfGrowth;
 
-    /// If the user has "all" keyword this is set to true
-    bool m_bAllNeihs;
-
     /// The diffusion rate
     double m_dDiffusionRate;
 
@@ -3,16 +3,24 @@
 namespace MicroProcesses
 {
 
-void simpleDiffusion( Diffusion* proc, Site* s){
-
-    vector<Site* > toDiffuse;
-    for ( Site* neigh:s->getNeighs() ) {
-        if ( !neigh->isOccupied() && s->getHeight() == neigh->getHeight() )
+//The performs change the state of the sites in the arrays of the lattice
+void simpleDiffusion( Diffusion* proc, Site* s, AffectedSites& affected ){
+    Lattice* lattice = proc->getLattice();
+    SiteArrays& a = lattice->getArrays();
+    const vector<Site*>& sites = lattice->getSites();
+    int id = s->getID();
+
+    //The vacant neighbours at the same height (the buffer is kept between the events so that nothing is allocated)
+    static thread_local vector<int> toDiffuse;
+    toDiffuse.clear();
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ) {
+        int neigh = a.neighIndex[ k ];
+        if ( !a.occupied[ neigh ] && a.heights[ id ] == a.heights[ neigh ] )
             toDiffuse.push_back( neigh );
     }
 
     // Random pick a site to re-adsorb
-    Site* diffuseSite;
+    int diffuseSite;
     if (  proc->getRandomGen() )
         diffuseSite = toDiffuse.at( proc->getRandomGen()->getIntRandom(0, toDiffuse.size()-1 ) );
     else{
@@ -21,49 +29,48 @@ void simpleDiffusion( Diffusion* proc, Site* s){
     }
 
     // do diffusion
-    diffuseSite->setLabel( s->getLabel() );
-    diffuseSite->setOccupied(true);
+    a.labels[ diffuseSite ] = a.labels[ id ];
+    a.occupied[ diffuseSite ] = true;
 
-    s->setLabel( s->getBelowLabel() );
-    s->setOccupied(false);
+    a.labels[ id ] = a.belowLabels[ id ];
+    a.occupied[ id ] = false;
     //--------------
 
-    proc->addAffectedSite( diffuseSite ) ;
-    for ( Site* neigh:diffuseSite->getNeighs() )
-        proc->addAffectedSite( neigh ) ;
+    affected.add( sites, diffuseSite );
+    affected.addNeighs( a, sites, diffuseSite );
 
-    proc->addAffectedSite( s ) ;
-    for ( Site* neigh:s->getNeighs() )
-        proc->addAffectedSite( neigh );
+    affected.add( sites, id );
+    affected.addNeighs( a, sites, id );
 }
 
 
 //proc is the case of Lam and Vlachos
-void performPVD(Diffusion* proc, Site* s){
+void performPVD(Diffusion* proc, Site* s, AffectedSites& affected ){
+    Lattice* lattice = proc->getLattice();
+    SiteArrays& a = lattice->getArrays();
+    const vector<Site*>& sites = lattice->getSites();
+    int id = s->getID();
 
     //----- This is desorption ------------------------------------------------------------->
-    s->decreaseHeight( 1 );
-    proc->calculateNeighbors( s ) ;
-    proc->getAffectedSites().insert( s );
-    for ( Site* neigh:s->getNeighs() ) {
-        proc->calculateNeighbors( neigh );
-        proc->getAffectedSites().insert( neigh );
-
-        for ( Site* firstNeigh:neigh->getNeighs() ){
-            firstNeigh->setNeighsNum( proc->calculateNeighbors( firstNeigh ) );
-            proc->getAffectedSites().insert( firstNeigh );
-        }
+    a.heights[ id ]--;
+    lattice->updateCoordination( id );
+    affected.add( sites, id );
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ) {
+        affected.add( sites, a.neighIndex[ k ] );
+        affected.addNeighs( a, sites, a.neighIndex[ k ] );
     }
     //--------------------------------------------------------------------------------------<
 
-    // Random pick a site to re-adsorpt
-    vector<Site* > toReAdsorpt;
-    for ( Site* neigh:s->getNeighs() ) {
-        if ( !neigh->isOccupied() && neigh->getHeight() == s->getHeight() - 1 )
+    // Random pick a site to re-adsorpt (from a buffer reused by every event)
+    static thread_local vector<int> toReAdsorpt;
+    toReAdsorpt.clear();
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ) {
+        int neigh = a.neighIndex[ k ];
+        if ( !a.occupied[ neigh ] && a.heights[ neigh ] == a.heights[ id ] - 1 )
             toReAdsorpt.push_back( neigh );
     }
 
-    Site* adsorbSite;
+    int adsorbSite;
     if (  proc->getRandomGen() )
         adsorbSite = toReAdsorpt.at( proc->getRandomGen()->getIntRandom(0, toReAdsorpt.size() - 1 ) );
     else{
@@ -72,14 +79,10 @@ void performPVD(Diffusion* proc, Site* s){
     }
 
     //----- proc is adsoprtion ------------------------------------------------------------->
-    s->increaseHeight( 1 );
-    proc->calculateNeighbors( s );
-    proc->getAffectedSites().insert( s ) ;
-
-    for ( Site* neigh:s->getNeighs() ) {
-        proc->calculateNeighbors( neigh );
-        proc->getAffectedSites().insert( neigh ) ;
-    }
+    a.heights[ id ]++;
+    lattice->updateCoordination( id );
+    affected.add( sites, id );
+    affected.addNeighs( a, sites, id );
     //--------------------------------------------------------------------------------------<
 }
 
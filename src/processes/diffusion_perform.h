@@ -2,6 +2,7 @@
 #define DIFFUSION_PERFORM_H
 
 #include "diffusion.h"
+#include "affected_sites.h"
 
 namespace MicroProcesses
 {
@@ -9,10 +10,10 @@ namespace MicroProcesses
 /** This is the simplest of diffusion.
  *  It takes particle X and moves it in a vacant site from its first neighbors
 **/
-void simpleDiffusion( Diffusion*, Site*);
+void simpleDiffusion( Diffusion*, Site*, AffectedSites&);
 
 /// The process is PVD as in Lam and Vlachos (2000)
-void performPVD( Diffusion*, Site*);
+void performPVD( Diffusion*, Site*, AffectedSites&);
 
 /// ToDo: Add dimer diffusion
 
@@ -3,40 +3,57 @@
 namespace MicroProcesses
 {
 
+//The rules read the state of the sites from the arrays of the lattice
 bool diffusionBasicRule( Diffusion* proc, Site* s){
 
-    if ( !s->isOccupied() || s->getLabel().compare( proc->getDiffused() ) != 0 ) return false;
+    const SiteArrays& a = proc->getLattice()->getArrays();
+    int id = s->getID();
 
-    for ( Site* neigh:s->getNeighs() )
-        if ( !neigh->isOccupied() && neigh->getHeight() == s->getHeight() )
+    if ( !a.occupied[ id ] || a.labels[ id ] != proc->getDiffused() ) return false;
+
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ){
+        int neigh = a.neighIndex[ k ];
+        if ( !a.occupied[ neigh ] && a.heights[ neigh ] == a.heights[ id ] )
             return true;
+    }
 
     return false;
 }
 
-bool diffusionBasicAllRule( Diffusion* proc, Site* s){
+bool diffusionAllRule( Diffusion* proc, Site* s){
+    return diffusionAllBin( proc, s ) == proc->getNumVacantSites();
+}
 
-    if ( !s->isOccupied() || s->getLabel().compare( proc->getDiffused() ) != 0
-         || proc->countVacantSites(s) != proc->getNumVacantSites() ) return false;
+int diffusionBasicAllBin( Diffusion* proc, Site* s){
 
-    for ( Site* neigh:s->getNeighs() )
-        if ( !neigh->isOccupied() && neigh->getHeight() == s->getHeight() )
-            return true;
+    const SiteArrays& a = proc->getLattice()->getArrays();
+    int id = s->getID();
 
-    return false;
+    if ( !a.occupied[ id ] || a.labels[ id ] != proc->getDiffused() ) return -1;
+
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ){
+        int neigh = a.neighIndex[ k ];
+        if ( !a.occupied[ neigh ] && a.heights[ neigh ] == a.heights[ id ] )
+            return proc->countVacantSites(s);
+    }
+
+    return -1;
 }
 
+int diffusionAllBin( Diffusion* proc, Site* s){
 
-bool diffusionAllRule( Diffusion* proc, Site* s){
+    const SiteArrays& a = proc->getLattice()->getArrays();
+    int id = s->getID();
 
-    if ( s->isOccupied() || !proc->isPartOfGrowth( s->getLabel() ) ||
-         proc->countVacantSites(s) != proc->getNumVacantSites() ) return false;
+    if ( a.occupied[ id ] || !proc->isPartOfGrowth( a.labels[ id ] ) ) return -1;
 
-    for ( Site* neigh:s->getNeighs() )
-        if ( !neigh->isOccupied() && s->getHeight() == neigh->getHeight() - 1 )
-            return true;
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ){
+        int neigh = a.neighIndex[ k ];
+        if ( !a.occupied[ neigh ] && a.heights[ id ] == a.heights[ neigh ] - 1 )
+            return proc->countVacantSites(s);
+    }
 
-    return false;
+    return -1;
 }
 
 }
@@ -17,7 +17,10 @@ bool diffusionBasicRule(Diffusion*, Site* s);
 bool diffusionAllRule(Diffusion*, Site* s);
 
 
-bool diffusionBasicAllRule( Diffusion* proc, Site* s);
+/// The bins of the two rules with the keyword "all": the number of vacant neighbours at the same height of the site
+/// (-1 if the species cannot be diffused from it)
+int diffusionAllBin( Diffusion* proc, Site* s);
+int diffusionBasicAllBin( Diffusion* proc, Site* s);
 
 }
 
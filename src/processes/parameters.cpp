@@ -21,7 +21,9 @@ namespace Utils
 {
 
 Parameters::Parameters(Apothesis* apothesis ):Pointers(apothesis), m_iRand(0), m_bReadHeightsFromFile(false),
-    m_bReadSpeciesFromFile(false), m_dStartTime(0.0){}
+    m_bReadSpeciesFromFile(false), m_dStartTime(0.0), m_sSelection("linear"), m_sEngine("class"), m_iThreads(1), m_dWindow(0.0), m_iResumEvery(100000),
+    m_iEnsemble(1), m_iEnsembleThreads(0),
+    m_dCheckpointEvery(0.0), m_sCheckpointFile("checkpoint.bin"), m_iWriteQueueSize(256), m_iNumSteps(0), m_iStepHeight(0), m_iTrajectoryKeyframes(1){}
   
   void Parameters::setProcess( string processName, vector< string > processParams )
   {
@@ -39,6 +41,10 @@ Parameters::Parameters(Apothesis* apothesis ):Pointers(apothesis), m_iRand(0), m
       cout << "Random gen init " << m_iRand << endl;
       cout << "Write in log every " << m_dWriteLogEvery << endl;
       cout << "Write lattice every " << m_dWriteLatticeEvery << endl;
+      cout << "Selection " << m_sSelection << endl;
+      cout << "Engine " << m_sEngine << endl;
+      cout << "Threads " << m_iThreads << endl;
+      cout << "Ensemble " << m_iEnsemble << endl;
       cout << "---------------------------------------- " << endl;
       cout << "--- end simulation parameters info ----- " << endl;
       cout << endl;
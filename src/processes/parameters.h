@@ -96,6 +96,36 @@ public:
     /// Set when to write lattice file
     inline double getWriteLatticeTimeStep() { return m_dWriteLatticeEvery; }
 
+    /// Sets the bound (in MB) of the output queued for the writer thread (zero: written by the simulation thread)
+    inline void setWriteQueueSize( int mb ) { m_iWriteQueueSize = mb; }
+
+    /// Returns the bound (in MB) of the output queued for the writer thread
+    inline int getWriteQueueSize() { return m_iWriteQueueSize; }
+
+    /// Sets the number of steps of a stepped surface (zero: flat surface)
+    inline void setNumSteps( int num ) { m_iNumSteps = num; }
+
+    /// Returns the number of steps of a stepped surface (zero: flat surface)
+    inline int getNumSteps() { return m_iNumSteps; }
+
+    /// Sets the height difference between two steps
+    inline void setStepHeight( int height ) { m_iStepHeight = height; }
+
+    /// Returns the height difference between two steps
+    inline int getStepHeight() { return m_iStepHeight; }
+
+    /// Sets the trajectory file for the lattice snapshots (empty: a text file per snapshot)
+    inline void setTrajectoryFile( string file ) { m_sTrajectoryFile = file; }
+
+    /// Returns the trajectory file for the lattice snapshots
+    inline string getTrajectoryFile() { return m_sTrajectoryFile; }
+
+    /// Sets the number of frames between two keyframes of the trajectory (1: every frame is written whole)
+    inline void setTrajectoryKeyframes( int n ) { m_iTrajectoryKeyframes = n; }
+
+    /// Returns the number of frames between two keyframes of the trajectory
+    inline int getTrajectoryKeyframes() { return m_iTrajectoryKeyframes; }
+
     /// Print parameters info
     void printInfo();
 
@@ -143,6 +173,69 @@ public:
     inline void setStartTime(double time){ m_dStartTime = time; }
     inline double getStartTime(){ return m_dStartTime; }
 
+    /// Sets the way a process is picked in each KMC step ("linear" or "tree")
+    inline void setSelection( string selection ){ m_sSelection = selection; }
+
+    /// Returns the way a process is picked in each KMC step
+    inline string getSelection(){ return m_sSelection; }
+
+    /// Sets the kinetic engine: "class" (processes and their classes of sites) or "nfold" (rates per site)
+    inline void setEngine( string engine ){ m_sEngine = engine; }
+
+    /// Returns the kinetic engine
+    inline string getEngine(){ return m_sEngine; }
+
+    /// Sets the number of threads (more than one for the synchronous sublattice parallel engine)
+    inline void setThreads( int threads ){ m_iThreads = threads; }
+
+    /// Returns the number of threads
+    inline int getThreads(){ return m_iThreads; }
+
+    /// Sets the time window of the parallel engine [s] (zero for the default: the inverse of the largest rate constant)
+    inline void setWindow( double window ){ m_dWindow = window; }
+
+    /// Returns the time window of the parallel engine [s]
+    inline double getWindow(){ return m_dWindow; }
+
+    /// Sets every how many events the total rate is recomputed from scratch
+    inline void setResumEvery( long events ){ m_iResumEvery = events; }
+
+    /// Returns every how many events the total rate is recomputed from scratch
+    inline long getResumEvery(){ return m_iResumEvery; }
+
+    /// Sets the number of replicas of the simulation (with different random seeds) that are averaged
+    inline void setEnsemble( int replicas ){ m_iEnsemble = replicas; }
+
+    /// Returns the number of replicas of the simulation
+    inline int getEnsemble(){ return m_iEnsemble; }
+
+    /// Sets the number of threads running the replicas (zero for the number of hardware threads)
+    inline void setEnsembleThreads( int threads ){ m_iEnsembleThreads = threads; }
+
+    /// Returns the number of threads running the replicas
+    inline int getEnsembleThreads(){ return m_iEnsembleThreads; }
+
+    /// Sets the values of a variable of the sweep ("temperature" or "pressure")
+    inline void setSweep( string variable, vector<double> values ){ m_mSweep[ variable ] = values; }
+
+    /// Returns the values of every variable of the sweep (empty if there is no sweep)
+    inline map< string, vector<double> > getSweep(){ return m_mSweep; }
+
+    /// Sets every how many seconds of wall time a checkpoint is written (zero for no checkpoints) and its file
+    inline void setCheckpoint( double every, string file ){ m_dCheckpointEvery = every; m_sCheckpointFile = file; }
+
+    /// Returns every how many seconds of wall time a checkpoint is written
+    inline double getCheckpointEvery(){ return m_dCheckpointEvery; }
+
+    /// Returns the file of the checkpoints
+    inline string getCheckpointFile(){ return m_sCheckpointFile; }
+
+    /// Sets the checkpoint file from which the run continues
+    inline void setRestartFile( string file ){ m_sRestartFile = file; }
+
+    /// Returns the checkpoint file from which the run continues (empty for a new run)
+    inline string getRestartFile(){ return m_sRestartFile; }
+
 protected:
 
     /// Parameters of the lattice
@@ -193,6 +286,54 @@ protected:
     /// The time for starting the simulation - default is zero.
     double m_dStartTime;
 
+    /// The selection engine for the processes - default is linear.
+    string m_sSelection;
+
+    /// The kinetic engine - default is class.
+    string m_sEngine;
+
+    /// The number of threads - default is 1.
+    int m_iThreads;
+
+    /// The time window of the parallel engine - default is 0 (the inverse of the largest rate constant).
+    double m_dWindow;
+
+    /// Every how many events the total rate is recomputed from scratch - default is 100000.
+    long m_iResumEvery;
+
+    /// The number of replicas of the simulation - default is 1.
+    int m_iEnsemble;
+
+    /// The number of threads running the replicas - default is 0 (the number of hardware threads).
+    int m_iEnsembleThreads;
+
+    /// The values of every variable of the sweep. The simulation runs for all their combinations.
+    map< string, vector<double> > m_mSweep;
+
+    /// Every how many seconds of wall time a checkpoint is written - default is 0 (no checkpoints).
+    double m_dCheckpointEvery;
+
+    /// The file of the checkpoints - default is checkpoint.bin.
+    string m_sCheckpointFile;
+
+    /// The checkpoint from which the run continues.
+    string m_sRestartFile;
+
+    /// The bound (in MB) of the output queued for the writer thread - default is 256 (0 for writing in the simulation thread).
+    int m_iWriteQueueSize;
+
+    /// The number of steps of the surface - default is zero (flat surface).
+    int m_iNumSteps;
+
+    /// The height difference between two steps.
+    int m_iStepHeight;
+
+    /// The trajectory file for the lattice snapshots - default is empty (a text file per snapshot).
+    string m_sTrajectoryFile;
+
+    /// The number of frames between two keyframes of the trajectory - default is 1 (no delta frames).
+    int m_iTrajectoryKeyframes;
+
 };
 
 }
@@ -16,15 +16,50 @@
 //============================================================================
 
 #include "process.h"
+#include "binary_stream.h"
 
-Process::Process():m_iHappened(0),m_bUncoAccept(false), m_iNumSites(1),  m_iNumNeighs(1), m_iNumVacant(1) {}
+#include <atomic>
+
+Process::Process():m_bUncoAccept(false), m_iNumSites(1),  m_iNumNeighs(1), m_iNumVacant(1), m_iRuleReads(ALL_STATES), m_iPerformWrites(ALL_STATES), m_iNumBins(1)
+{
+    static atomic<long> serial( 0 );
+    m_iSerial = serial++;
+}
 Process::~Process(){}
 
-bool Process::isPartOfGrowth( string name ){
-    for ( string species: m_pUtilParams->getGrowthSpecies() ){
-        if ( species.compare( name ) == 0 )
-            return true;
+void Process::setSysParams( Utils::Parameters* p ){
+    m_pUtilParams = p;
+
+    m_vGrowthSpecies.clear();
+    for ( string species: m_pUtilParams->getGrowthSpecies() )
+        m_vGrowthSpecies.push_back( SpeciesRegistry::intern( species ) );
+}
+
+void Process::mf_buildRates( bool binned, const function<double( int )>& rate )
+{
+    m_vRates.clear();
+    if ( m_iNumBins <= 1 )
+        m_vRates.push_back( m_dRateConstant );
+    else if ( binned ){
+        for ( int n = 0; n < m_iNumBins; n++ )
+            m_vRates.push_back( rate( n ) );
     }
+    else {
+        double sum = 0.0;
+        for ( int n = 0; n < m_iNumBins; n++ )
+            sum += rate( n );
+        m_vRates.push_back( sum );
+    }
+
+    m_vHappened.assign( m_vRates.size(), 0 );
+}
+
+void Process::writeState( ostream& out, int bin )
+{
+    Utils::writeBinary( out, m_vHappened[ bin ] );
+}
 
-    return false;
+void Process::readState( istream& in, int bin )
+{
+    Utils::readBinary( in, m_vHappened[ bin ] );
 }
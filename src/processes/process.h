@@ -22,6 +22,7 @@
 #include <string>
 #include <map>
 #include <any>
+#include <functional>
 #include "lattice.h"
 #include "site.h"
 #include "extLibs/random_generator.h"
@@ -38,6 +39,20 @@ using namespace Utils;
 namespace MicroProcesses
 {
 
+class AffectedSites;
+
+/** The state of a site that a rule may read and a perform may change.
+ * Used as bit flags for building the dependencies between the processes. */
+enum SiteState {
+    HEIGHT = 1,
+    LABEL = 2,
+    OCCUPIED = 4,
+    NEIGH_HEIGHT = 8,
+    NEIGH_LABEL = 16,
+    NEIGH_OCCUPIED = 32,
+    ALL_STATES = 63
+};
+
 class Process
 {
 
@@ -45,43 +60,65 @@ public:
     Process();
     virtual ~Process();
 
-    ///Get probability
-    double getRateConstant(){ return m_dRateConstant; }
+    /// Sets the number of bins of the process before its initialization. With the keyword "all" the rate constant
+    /// depends on the number of (vacant) 1st neighbours of the site and the process has one bin for each number.
+    inline void setNumBins( int n ){ m_iNumBins = n; }
+
+    /// Returns the number of bins of the rate table (one if the rate constant does not depend on the site)
+    inline int getNumBins(){ return m_vRates.size(); }
+
+    /// Returns the rate constant of a bin
+    inline double getRateConstant( int bin ){ return m_vRates[ bin ]; }
+
+    /// Returns the bin of the rate table for the site or -1 if the process cannot be performed in it.
+    /// The rule is evaluated once for all the bins.
+    virtual int getBin( Site* s ){ return rules( s ) ? 0 : -1; }
+
+    /// Returns the name of a bin (added to the name of the process in the output)
+    virtual string getBinName( int /*bin*/ ){ return ""; }
 
-    /// Perform this process in the site and compute/store the affected sites
-    virtual void perform( Site* ) = 0;
+    /// Perform this process in the site. The sites affected by it (including the site it is performed) are
+    /// stored in affected, which is cleared first. The process keeps no state of the event so the same process can
+    /// be performed with different buffers.
+    virtual void perform( Site*, AffectedSites& affected ) = 0;
 
     /// The rules for this type of process e.g. the neighbour of site Site.
     virtual bool rules( Site* ) = 0;
 
+    /// Returns a copy of this process. The copy shares the lattice, the parameters and the random generator
+    /// of this process (used by the threads of the parallel engine, which set their own random generator).
+    virtual Process* clone() = 0;
+
     /// Initialization for this process (e.g. temperature, pressure, mole fraction etc.)
     /// This must be for every process according to the process
     virtual void init( vector<string> params ){ m_vParams = params; }
 
-    /// Returns the sites that are affected by this process including the site that this process is performed.
-    inline set<Site*> getAffectedSites() { return m_seAffectedSites; }
-    inline void addAffectedSite( Site* s) { m_seAffectedSites.insert(s);}
-    inline void clearAffectedSite() { m_seAffectedSites.clear(); }
-
     inline void setName( string procName ){ m_sProcName = procName; }
     inline string getName(){ return  m_sProcName; }
 
     inline void setID( int id ){ m_iID = id; }
     inline int getID(){ return m_iID; }
 
+    /// Returns the order in which the process was created
+    inline long getSerial(){ return m_iSerial; }
+
     inline void setLattice( Lattice* lattice ){ m_pLattice = lattice; }
     inline Lattice* getLattice(){ return m_pLattice; }
 
-    /// Counts how many times this process happens
-    inline void eventHappened(){ m_iHappened++; }
+    /// Counts how many times this process happens in a bin
+    inline void eventHappened( int bin ){ m_vHappened[ bin ]++; }
 
-    /// Returns how many times this process happened
-    int getNumEventHappened(){ return m_iHappened; }
+    /// Adds n events of this process in a bin (performed by a copy of it)
+    inline void eventsHappened( int bin, int n ){ m_vHappened[ bin ] += n; }
+
+    /// Returns how many times this process happened in a bin
+    int getNumEventHappened( int bin ){ return m_vHappened[ bin ]; }
 
     /// Set the random generator
     inline void setRandomGen( RandomGen::RandomGenerator* randgen ) { m_pRandomGen = randgen; }
 
-    inline void setSysParams( Utils::Parameters* p) { m_pUtilParams = p; }
+    /// Sets the parameters of the system (and interns the species of the growing film)
+    void setSysParams( Utils::Parameters* p);
     inline void setErrorHandler( ErrorHandler* error ) { m_error = error; }
 
     inline void setUncoAccepted( bool isUncoAccepted) { m_bUncoAccept = isUncoAccepted; }
@@ -95,14 +132,38 @@ public:
     inline void setNumVacantSites( int i){ m_iNumVacant = i;}
     inline int getNumVacantSites(){ return m_iNumVacant;}
 
+    /// Returns the state (SiteState flags) of a site and its neighbours that the rule of this process reads
+    inline int getRuleReads(){ return m_iRuleReads; }
+
+    /// Returns the state (SiteState flags) of the sites that the perform of this process changes
+    inline int getPerformWrites(){ return m_iPerformWrites; }
+
+    /// True if performing this process may change the result of the rule of process p.
+    /// A state changed on a site is also a neighbour state for the sites around it.
+    inline bool mayChangeRuleOf( Process* p ){
+        int changed = m_iPerformWrites | ( m_iPerformWrites << 3 );
+        return ( changed & p->getRuleReads() ) != 0;
+    }
+
     /// Retrurns the random generator
     RandomGen::RandomGenerator* getRandomGen(){ return m_pRandomGen; }
 
     /// Retrurns the parameters
     Utils::Parameters* getParameters(){ return m_pUtilParams; }
 
-    /// Checks if the specific species is part of the growing film
-    bool isPartOfGrowth( string name);
+    /// Checks if the specific species (its ID in the SpeciesRegistry) is part of the growing film
+    inline bool isPartOfGrowth( int species ){
+        for ( int gs:m_vGrowthSpecies )
+            if ( gs == species )
+                return true;
+        return false;
+    }
+
+    /// Writes the state of a bin that changes during the run: the number of events (for the checkpoints)
+    void writeState( ostream& out, int bin );
+
+    /// Reads the state of a bin written by writeState
+    void readState( istream& in, int bin );
 
 protected:
 
@@ -112,6 +173,9 @@ protected:
     ///The parameters of the system and constant values
     Utils::Parameters* m_pUtilParams;
 
+    /// The IDs of the species of the growing film
+    vector<int> m_vGrowthSpecies;
+
     /// Error handler for the processes
     ErrorHandler* m_error;
 
@@ -120,9 +184,6 @@ protected:
     /// followed by the parameters needed for this process to perform
     vector<string> m_vParams;
 
-    ///A list holding all affected sites from this process
-    set<Site*> m_seAffectedSites;
-
     ///The random generator
     RandomGen::RandomGenerator* m_pRandomGen;
 
@@ -147,12 +208,32 @@ protected:
     /// The number of vacant sites of this process (default 1)
     int m_iNumVacant;
 
+    /// The state read by the rule of this process (SiteState flags - default all)
+    int m_iRuleReads;
+
+    /// The state changed by the perform of this process (SiteState flags - default all)
+    int m_iPerformWrites;
+
+    /// The number of bins set before the initialization (default 1)
+    int m_iNumBins;
+
+    /// Builds the rate table at the end of the initialization. Without bins it holds the rate constant of the process.
+    /// Else it holds rate( n ) for every bin n if binned is true, or their sum in a single bin if the rule of the process
+    /// does not depend on the number of neighbours (then all the bins hold the same sites).
+    void mf_buildRates( bool binned, const function<double( int )>& rate );
+
 private:
     /// The id of the process
     int m_iID;
 
-    /// Counts the times that this processes happened
-    int m_iHappened;
+    /// The rate constant of each bin
+    vector<double> m_vRates;
+
+    /// Counts the times that this processes happened in each bin
+    vector<int> m_vHappened;
+
+    /// The order in which the process was created (copied by clone)
+    long m_iSerial;
 };
 }
 
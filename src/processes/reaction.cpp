@@ -16,6 +16,7 @@
 //============================================================================
 
 #include "reaction.h"
+#include "affected_sites.h"
 
 Reaction::Reaction(): m_bLeadsToGrowth(false){}
 Reaction::~Reaction(){}
@@ -44,31 +45,32 @@ void Reaction::init(vector<string> params){
         EXIT
     }
 
-    vector<string> gSpecies = m_pUtilParams->getGrowthSpecies();
+    //A reaction has a single rate constant
+    mf_buildRates( false, nullptr );
 
     buildTransformationMatrix();
 
-    if ( gSpecies.size() <= 0 )
-        m_bLeadsToGrowth = false;
-    else {
-        for ( string rs:m_vProducts) {
-            for ( string gs:gSpecies ){
-                if ( gs.compare( rs) == 0 ) {
-                    m_bLeadsToGrowth = true;
-                    break;
-                }
-            }
+    m_bLeadsToGrowth = false;
+    for ( string rs:m_vProducts) {
+        if ( isPartOfGrowth( SpeciesRegistry::intern( rs ) ) ) {
+            m_bLeadsToGrowth = true;
+            break;
         }
     }
 
+    //The state read by each rule and changed by each perform is kept for re-evaluating only the dependent rules after an event.
     if ( !m_bLeadsToGrowth ) {
         m_fRules = &Reaction::simpleRule;
         m_fPerform = &Reaction::catalysis;
+        m_iRuleReads = OCCUPIED | LABEL | NEIGH_LABEL;
+        m_iPerformWrites = OCCUPIED | LABEL;
     }
     else {
         if ( allReactCoeffOne() && m_vReactants.size() == 2 && m_vProducts.size() <= 2  ){
             m_fRules = &Reaction::oneOneRule;
             m_fPerform = &Reaction::oneOneReaction;
+            m_iRuleReads = OCCUPIED | LABEL | HEIGHT | NEIGH_LABEL | NEIGH_HEIGHT;
+            m_iPerformWrites = OCCUPIED | LABEL | HEIGHT;
         }
     }
 }
@@ -76,14 +78,25 @@ void Reaction::init(vector<string> params){
 void Reaction::buildTransformationMatrix(){
     int iCount = 0;
     for (string r:m_vReactants ) {
-        if ( iCount < m_vProducts.size() ) {
-            m_mTransformationMatrix[ r ] = m_vProducts[ iCount ];
-        }
+        int reactant = SpeciesRegistry::intern( r );
+        if ( reactant >= m_vTransformationMatrix.size() )
+            m_vTransformationMatrix.resize( reactant + 1, SpeciesRegistry::NONE );
+
+        if ( iCount < m_vProducts.size() )
+            m_vTransformationMatrix[ reactant ] = SpeciesRegistry::intern( m_vProducts[ iCount ] );
         else
-            m_mTransformationMatrix[ r ] = "";
+            m_vTransformationMatrix[ reactant ] = SpeciesRegistry::NONE;
 
         iCount++;
     }
+
+    for ( auto &r:m_mReactants ) {
+        int reactant = SpeciesRegistry::intern( r.first );
+        if ( reactant >= m_vIsReactant.size() )
+            m_vIsReactant.resize( reactant + 1, false );
+
+        m_vIsReactant[ reactant ] = true;
+    }
 }
 
 bool Reaction::allReactCoeffOne(){
@@ -106,38 +119,39 @@ void Reaction::arrheniusType(double v0, double Ed, double T)
     m_dRateConstant = v0*exp(-Ed/(k*T));
 }
 
-bool Reaction::leadsToGrowth(Site* s){
-    vector<string> gSpecies = m_pUtilParams->getGrowthSpecies();
+bool Reaction::leadsToGrowth( int species ){
+    int product = transformed( species );
 
-    if ( m_mTransformationMatrix[ s->getLabel() ] == "")
+    if ( product == SpeciesRegistry::NONE )
         return false;
 
-    for ( string gs:gSpecies ){
-        if ( gs.compare( m_mTransformationMatrix[ s->getLabel() ] ) == 0 ) {
-            return true;
-        }
-    }
-
-    return false;
+    return isPartOfGrowth( product );
 }
 
-void Reaction::oneOneReaction( Site* s){
-    vector<Site* > potSites;
-    for ( Site* s1:s->getNeighs() ) {
-        if ( s1->getLabel().compare( s->getLabel() ) != 0 && isReactant(s1) && s1->getHeight() == s->getHeight() )
+void Reaction::oneOneReaction( Site* s, AffectedSites& affected ){
+    SiteArrays& a = m_pLattice->getArrays();
+    const vector<Site*>& sites = m_pLattice->getSites();
+    int id = s->getID();
+
+    //The neighbouring reactants at the same height (the buffer is reused by every event)
+    static thread_local vector<int> potSites;
+    potSites.clear();
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ) {
+        int s1 = a.neighIndex[ k ];
+        if ( a.labels[ s1 ] != a.labels[ id ] && isReactant( a.labels[ s1 ] ) && a.heights[ s1 ] == a.heights[ id ] )
             potSites.push_back( s1 );
     }
 
     int lucky = m_pRandomGen->getIntRandom(0, potSites.size() - 1 );
 
-    Site* otherSite = potSites[ lucky ];
+    int otherSite = potSites[ lucky ];
 
-    if ( !isReactant(s ) || !isReactant(otherSite ) || otherSite->getLabel().compare( s->getLabel() ) == 0 ||
-         otherSite->getHeight() != s->getHeight() ){
-        cout << s->getID() << " " << otherSite->getID() << endl;
+    if ( !isReactant( a.labels[ id ] ) || !isReactant( a.labels[ otherSite ] ) || a.labels[ otherSite ] == a.labels[ id ] ||
+         a.heights[ otherSite ] != a.heights[ id ] ){
+        cout << id << " " << otherSite << endl;
         cout << "Problem with performing reaction." << endl;
-        otherSite->setOccupied( false );
-        otherSite->setLabel( "X" );
+        a.occupied[ otherSite ] = false;
+        a.labels[ otherSite ] = SpeciesRegistry::intern( "X" );
 
         std::string name = std::string("SurfaceSpecies") + std::string("ERROR") + std::string(".dat");
         std::ofstream file(name);
@@ -146,7 +160,7 @@ void Reaction::oneOneReaction( Site* s){
 
         for (int i = 0; i < m_pLattice->getY(); i++){
             for (int j = 0; j < m_pLattice->getX(); j++)
-                file << m_pLattice->getSite( i*m_pLattice->getX() + j )->getLabel() << " " ;
+                file << m_pLattice->getSite( i*m_pLattice->getX() + j )->getLabelName() << " " ;
 
             file << endl;
         }
@@ -154,41 +168,47 @@ void Reaction::oneOneReaction( Site* s){
     }
 
 
-    if ( leadsToGrowth(s) )
-        s->increaseHeight(1);
+    if ( leadsToGrowth( a.labels[ id ] ) ){
+        a.heights[ id ]++;
+        m_pLattice->updateCoordination( id );
+    }
 
-    if ( leadsToGrowth(otherSite) )
-        otherSite->increaseHeight(1);
+    if ( leadsToGrowth( a.labels[ otherSite ] ) ){
+        a.heights[ otherSite ]++;
+        m_pLattice->updateCoordination( otherSite );
+    }
 
-    s->setOccupied(false);
-    if ( m_mTransformationMatrix[ s->getLabel() ] != "" )
-        s->setLabel( m_mTransformationMatrix[s->getLabel() ] );
+    a.occupied[ id ] = false;
+    if ( transformed( a.labels[ id ] ) != SpeciesRegistry::NONE )
+        a.labels[ id ] = transformed( a.labels[ id ] );
     else
-        s->setLabel( s->getBelowLabel() );
+        a.labels[ id ] = a.belowLabels[ id ];
 
-    m_seAffectedSites.insert( s );
-    for ( Site* neigh:s->getNeighs() )
-        m_seAffectedSites.insert( neigh );
+    affected.add( sites, id );
+    affected.addNeighs( a, sites, id );
 
-    otherSite->setOccupied( false );
-    if ( m_mTransformationMatrix[ otherSite->getLabel() ] != "" )
-        otherSite->setLabel( m_mTransformationMatrix[ otherSite->getLabel() ] );
+    a.occupied[ otherSite ] = false;
+    if ( transformed( a.labels[ otherSite ] ) != SpeciesRegistry::NONE )
+        a.labels[ otherSite ] = transformed( a.labels[ otherSite ] );
     else
-        otherSite->setLabel( otherSite->getBelowLabel() );
+        a.labels[ otherSite ] = a.belowLabels[ otherSite ];
 
-    m_seAffectedSites.insert( otherSite );
-    for ( Site* neigh:otherSite->getNeighs() )
-        m_seAffectedSites.insert( neigh );
+    affected.add( sites, otherSite );
+    affected.addNeighs( a, sites, otherSite );
 }
 
 bool Reaction::oneOneRule(Site* s){
-    if ( !s->isOccupied() ) return false;
+    const SiteArrays& a = m_pLattice->getArrays();
+    int id = s->getID();
+
+    if ( !a.occupied[ id ] ) return false;
 
-    if ( !isReactant( s ) ) return false;
+    if ( !isReactant( a.labels[ id ] ) ) return false;
     else {
         //Search for the other sites
-        for ( Site* s1:s->getNeighs() ) {
-            if ( s1->getLabel().compare( s->getLabel() ) != 0 && isReactant( s1 ) && s->getHeight() == s1->getHeight() )
+        for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ){
+            int s1 = a.neighIndex[ k ];
+            if ( a.labels[ s1 ] != a.labels[ id ] && isReactant( a.labels[ s1 ] ) && a.heights[ id ] == a.heights[ s1 ] )
                 return true;
         }
     }
@@ -197,13 +217,17 @@ bool Reaction::oneOneRule(Site* s){
 
 
 bool Reaction::simpleRule(Site* s){
-    if ( !s->isOccupied() ) return false;
+    const SiteArrays& a = m_pLattice->getArrays();
+    int id = s->getID();
+
+    if ( !a.occupied[ id ] ) return false;
 
-    if ( !isReactant( s ) ) return false;
+    if ( !isReactant( a.labels[ id ] ) ) return false;
     else {
-        //Search for the other sitesb
-        for ( Site* s1:s->getNeighs() ) {
-            if ( s1->getLabel().compare( s->getLabel() ) != 0 && isReactant( s1 ) )
+        //Search for the other sites
+        for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ){
+            int s1 = a.neighIndex[ k ];
+            if ( a.labels[ s1 ] != a.labels[ id ] && isReactant( a.labels[ s1 ] ) )
                 return true;
         }
     }
@@ -215,40 +239,37 @@ bool Reaction::rules(Site *s)
     return (this->*m_fRules)(s);
 }
 
-bool Reaction::isReactant(Site* s){
-
-    auto it = m_mReactants.find( s->getLabel() );
-    if ( it != m_mReactants.end() )
-        return true;
-    return false;
-}
-
-void Reaction::perform(Site *s)
+void Reaction::perform(Site *s, AffectedSites& affected)
 {
-    (this->*m_fPerform)(s);
+    affected.clear();
+    (this->*m_fPerform)(s, affected);
 }
 
-void Reaction::catalysis(Site *s){
-
-    m_seAffectedSites.clear();
-
-    vector<Site* > potSites;
-    for ( Site* s1:s->getNeighs() ) {
-        if ( s1->getLabel().compare( s->getLabel() ) != 0 && isReactant(s1) )
+void Reaction::catalysis(Site *s, AffectedSites& affected){
+    SiteArrays& a = m_pLattice->getArrays();
+    const vector<Site*>& sites = m_pLattice->getSites();
+    int id = s->getID();
+
+    //The neighbouring reactants (the buffer is reused by every event)
+    static thread_local vector<int> potSites;
+    potSites.clear();
+    for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ) {
+        int s1 = a.neighIndex[ k ];
+        if ( a.labels[ s1 ] != a.labels[ id ] && isReactant( a.labels[ s1 ] ) )
             potSites.push_back( s1 );
     }
 
     int lucky = m_pRandomGen->getIntRandom(0, potSites.size() - 1 );
-    Site* otherSite = potSites[ lucky ];
+    int otherSite = potSites[ lucky ];
 
-    if ( !isReactant(otherSite ) || otherSite->getLabel().compare( s->getLabel() ) == 0){
+    if ( !isReactant( a.labels[ otherSite ] ) || a.labels[ otherSite ] == a.labels[ id ] ){
 
-        cout << s->getID() << " " << otherSite->getID() << endl;
+        cout << id << " " << otherSite << endl;
 
         cout << "Problem with performing reaction." << endl;
 
-        otherSite->setOccupied( false );
-        otherSite->setLabel( "X" );
+        a.occupied[ otherSite ] = false;
+        a.labels[ otherSite ] = SpeciesRegistry::intern( "X" );
 
         std::string name = std::string("SurfaceSpecies") + std::string("ERROR") + std::string(".dat");
         std::ofstream file(name);
@@ -257,7 +278,7 @@ void Reaction::catalysis(Site *s){
 
         for (int i = 0; i < m_pLattice->getY(); i++){
             for (int j = 0; j < m_pLattice->getX(); j++)
-                file << m_pLattice->getSite( i*m_pLattice->getX() + j )->getLabel() << " " ;
+                file << m_pLattice->getSite( i*m_pLattice->getX() + j )->getLabelName() << " " ;
 
             file << endl;
         }
@@ -265,15 +286,13 @@ void Reaction::catalysis(Site *s){
         EXIT;
     }
 
-    s->setOccupied(false);
-    s->setLabel( s->getBelowLabel() );
-    m_seAffectedSites.insert( s );
-    for ( Site* neigh:s->getNeighs() )
-        m_seAffectedSites.insert( neigh );
-
-    otherSite->setOccupied( false );
-    otherSite->setLabel( otherSite->getBelowLabel() );
-    m_seAffectedSites.insert( otherSite );
-    for ( Site* neigh:otherSite->getNeighs() )
-        m_seAffectedSites.insert( neigh );
+    a.occupied[ id ] = false;
+    a.labels[ id ] = a.belowLabels[ id ];
+    affected.add( sites, id );
+    affected.addNeighs( a, sites, id );
+
+    a.occupied[ otherSite ] = false;
+    a.labels[ otherSite ] = a.belowLabels[ otherSite ];
+    affected.add( sites, otherSite );
+    affected.addNeighs( a, sites, otherSite );
 }
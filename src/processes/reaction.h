@@ -35,7 +35,8 @@ public:
     Reaction();
     ~Reaction();
 
-    void perform(Site *) override;
+    void perform(Site *, AffectedSites& affected) override;
+    Process* clone() override { return new Reaction( *this ); }
     bool rules(Site *) override;
     void init(vector<string> params) override;
 
@@ -52,7 +53,7 @@ private:
     /// Pointers to functions in order to switch between different functions
     void (Reaction::*m_fType)();
     bool (Reaction::*m_fRules)(Site*);
-    void (Reaction::*m_fPerform)(Site*);
+    void (Reaction::*m_fPerform)(Site*, AffectedSites&);
 
     vector<string> m_vReactants;
     vector<int> m_vCoefReactants;
@@ -67,10 +68,10 @@ private:
     void constantType();
 
     /// Reactions without growth taken into account
-    void catalysis(Site* s);
+    void catalysis(Site* s, AffectedSites& affected);
 
     /// 1-1 Reaction, e.g. A* + B* -> AB*
-    void oneOneReaction(Site* s);
+    void oneOneReaction(Site* s, AffectedSites& affected);
     bool oneOneRule(Site* s);
 
     bool simpleRule(Site* s);
@@ -81,8 +82,13 @@ private:
     /// The products of this reaction
     unordered_map<string, int> m_mProducts;
 
-    /// Checks if the site is a reactant
-    bool isReactant(Site* s);
+    /// True for the IDs of the species that are reactants (indexed by the ID in the SpeciesRegistry)
+    vector<char> m_vIsReactant;
+
+    /// Checks if the species is a reactant
+    inline bool isReactant( int species ){
+        return species >= 0 && species < m_vIsReactant.size() && m_vIsReactant[ species ];
+    }
 
     double m_dReactionRate;
 
@@ -93,12 +99,21 @@ private:
     bool allReactCoeffOne();
 
     /// Holds the species what to be tranformed according to the reaction e.g. A + B -> C + D, then A will be replaced by C and b by D and so on and so forth.
-    unordered_map<string, string> m_mTransformationMatrix;
+    /// Indexed by the ID of the reactant, it holds the ID of the product or SpeciesRegistry::NONE if the reactant is not transformed.
+    vector<int> m_vTransformationMatrix;
+
+    /// Returns the ID of the species that the species is transformed to (SpeciesRegistry::NONE if it is not transformed)
+    inline int transformed( int species ){
+        if ( species < 0 || species >= m_vTransformationMatrix.size() )
+            return SpeciesRegistry::NONE;
+        return m_vTransformationMatrix[ species ];
+    }
 
-    /// Constructs the transformation matrix.
+    /// Constructs the transformation matrix and the reactant flags.
     void buildTransformationMatrix();
 
-    bool leadsToGrowth(Site* s);
+    /// Checks if the species is transformed to a growth species
+    bool leadsToGrowth( int species );
 };
 
 #endif // REACTION_NEW_H
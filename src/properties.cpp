@@ -1,39 +1,100 @@
 #include "properties.h"
-
+#include "affected_sites.h"
 
 namespace Utils {
 
 Properties::Properties(Apothesis* apothesis ):
-    Pointers( apothesis ),m_dRoughness(0.0), m_dRMS(0.0),m_dEvGrRate(0.0)
+    Pointers( apothesis ), m_bValid(false), m_iSumH(0), m_iSumH2(0), m_iSumDH(0), m_dRoughness(0.0), m_dRMS(0.0),m_dEvGrRate(0.0)
 {}
 
-
-double Properties::getMicroroughness()
+void Properties::mf_sums( long long& sumH, long long& sumH2, long long& sumDH )
 {
-    double dRough = 0.0;
+    const SiteArrays& a = m_lattice->getArrays();
+
+    sumH = 0;
+    sumH2 = 0;
+    sumDH = 0;
     for ( int i = 0; i < m_lattice->getSize(); i++){
-        for (Site* s:m_lattice->getSite( i )->getNeighs() )
-            dRough += abs( s->getHeight() - m_lattice->getSite( i )->getHeight() );
+        sumH += a.heights[ i ];
+        sumH2 += (long long)a.heights[ i ]*a.heights[ i ];
+        for ( int k = a.neighBegin( i ); k < a.neighEnd( i ); k++ )
+            sumDH += abs( a.heights[ a.neighIndex[ k ] ] - a.heights[ i ] );
     }
+}
+
+void Properties::mf_resync()
+{
+    mf_sums( m_iSumH, m_iSumH2, m_iSumDH );
+    m_vHeights = m_lattice->getArrays().heights;
 
-    return 1. + dRough/(2.*m_lattice->getSize());
+    m_bValid = true;
 }
 
-double Properties::getRMS()
+void Properties::update( const MicroProcesses::AffectedSites& affected )
+{
+    //The sums are recomputed when they are needed
+    if ( !m_bValid )
+        return;
+
+    const SiteArrays& a = m_lattice->getArrays();
+
+    for ( Site* s:affected ){
+        int id = s->getID();
+        int h = a.heights[ id ];
+        int old = m_vHeights[ id ];
+        if ( h == old )
+            continue;
+
+        m_iSumH += h - old;
+        m_iSumH2 += (long long)h*h - (long long)old*old;
+
+        //The pairs of this site with its neighbours and of the sites that have it as neighbour
+        for ( int k = a.neighBegin( id ); k < a.neighEnd( id ); k++ ){
+            int hj = m_vHeights[ a.neighIndex[ k ] ];
+            m_iSumDH += abs( hj - h ) - abs( hj - old );
+        }
+
+        for ( int k = a.revBegin( id ); k < a.revEnd( id ); k++ ){
+            int hj = m_vHeights[ a.revIndex[ k ] ];
+            m_iSumDH += abs( h - hj ) - abs( old - hj );
+        }
+
+        m_vHeights[ id ] = h;
+    }
+}
+
+bool Properties::check()
 {
-    double sum = 0;
-    double mean = 0;
-    double dev = 0;
+    if ( !m_bValid )
+        return true;
 
-    for (unsigned int i=0; i< m_lattice->getSize(); i++)
-        sum += m_lattice->getSite( i )->getHeight();
+    long long sumH, sumH2, sumDH;
+    mf_sums( sumH, sumH2, sumDH );
 
-    mean = sum/(double)m_lattice->getSize();
+    if ( sumH != m_iSumH || sumH2 != m_iSumH2 || sumDH != m_iSumDH ){
+        m_errorHandler->warningSimple_msg( "The incremental surface sums (" + to_string( m_iSumH ) + ", " + to_string( m_iSumH2 ) + ", " +
+                                           to_string( m_iSumDH ) + ") differ from the full sums (" + to_string( sumH ) + ", " +
+                                           to_string( sumH2 ) + ", " + to_string( sumDH ) + ")" );
+        return false;
+    }
 
-    for (unsigned int i=0; i<m_lattice->getSize(); i++)
-        dev += m_lattice->getSite( i )->getHeight()*m_lattice->getSite( i )->getHeight();
+    return true;
+}
+
+double Properties::getMicroroughness()
+{
+    if ( !m_bValid )
+        mf_resync();
+
+    return 1. + m_iSumDH/(2.*m_lattice->getSize());
+}
+
+double Properties::getRMS()
+{
+    if ( !m_bValid )
+        mf_resync();
 
-    return sqrt( dev/(double)m_lattice->getSize() );
+    return sqrt( m_iSumH2/(double)m_lattice->getSize() );
 }
 
 double Properties::eventCountingGrowthRate( int adsorptionCounts, int desortionCounts, double time)
@@ -49,10 +110,11 @@ double Properties::getMeanDH()
     double mean = 0.0, sum = 0.0 ;
     if ( m_lattice->getType() == Lattice::FCC ){
         int iCount = 0;
+        int cu = SpeciesRegistry::find( "Cu" );
         for (unsigned int i=0; i< m_lattice->getSize(); i++){
             //This is not correct. It should just counts the height. What it is there should be seen by the individual processes.
-            if ( m_lattice->getSite( i )->getLabel() == "Cu"){
-                if ( m_lattice->getSite(i)->getHeight() > m_lattice->getSite(i)->get1stNeihbors()[ -1 ][ 0 ]->getHeight() ){
+            if ( m_lattice->getSite( i )->getLabel() == cu ){
+                if ( m_lattice->getSite(i)->getHeight() > m_lattice->getSite(i)->get1stNeihbors( -1 )[ 0 ]->getHeight() ){
                     sum += m_lattice->getSite( i )->getHeight();
                     iCount++;
                 }
@@ -62,10 +124,10 @@ double Properties::getMeanDH()
         mean = sum/iCount;
     }
     else if ( m_lattice->getType() == Lattice::SimpleCubic ){
-        for (unsigned int i=0; i< m_lattice->getSize(); i++)
-            sum += (double)m_lattice->getSite( i )->getHeight();
+        if ( !m_bValid )
+            mf_resync();
 
-        mean = sum/(double)m_lattice->getSize();
+        mean = m_iSumH/(double)m_lattice->getSize();
     }
 
     return mean;
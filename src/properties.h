@@ -28,6 +28,10 @@ using namespace std;
 
 namespace Utils {
 
+/** The properties of the surface. The sums of the heights, of the squared heights and of the height differences
+ * between neighbours are kept up to date from the sites affected by each event (update), so the mean height,
+ * the RMS and the micro-roughness are O(1). The sums are recomputed from the lattice when they are first
+ * needed after invalidate (the lattice changed outside the events, e.g. restart or the parallel engine). */
 class Properties: public Pointers
 {
 public:
@@ -41,7 +45,37 @@ public:
     double classCoverage();
     double getMeanDH();
 
+    /// Updates the sums after an event from the sites it affected (the sites whose height changed must be among them)
+    void update( const MicroProcesses::AffectedSites& affected );
+
+    /// The sums are recomputed from the lattice when they are needed next
+    inline void invalidate(){ m_bValid = false; }
+
+    /// Compares the sums with a full recomputation. Warns and returns false if they differ (debug mode).
+    bool check();
+
 private:
+    /// Recomputes the sums and the heights they correspond to from the lattice
+    void mf_resync();
+
+    /// Computes the sums from the lattice
+    void mf_sums( long long& sumH, long long& sumH2, long long& sumDH );
+
+    /// True if the sums correspond to the lattice
+    bool m_bValid;
+
+    /// The sum of the heights
+    long long m_iSumH;
+
+    /// The sum of the squared heights
+    long long m_iSumH2;
+
+    /// The sum of |h_j - h_i| over every site i and its neighbours j
+    long long m_iSumDH;
+
+    /// The heights of the sites that the sums correspond to
+    vector<int> m_vHeights;
+
     //The roughness of the surface
     double m_dRoughness;
 
@@ -0,0 +1,71 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#include "species_registry.h"
+
+int SpeciesRegistry::intern( const string& name ){
+    if ( name.empty() )
+        return NONE;
+
+    lock_guard< mutex > lock( getMutex() );
+
+    auto it = getIDs().find( name );
+    if ( it != getIDs().end() )
+        return it->second;
+
+    getNames().push_back( name );
+    return getIDs()[ name ] = getNames().size() - 1;
+}
+
+int SpeciesRegistry::find( const string& name ){
+    lock_guard< mutex > lock( getMutex() );
+
+    auto it = getIDs().find( name );
+    if ( it != getIDs().end() )
+        return it->second;
+
+    return NONE;
+}
+
+string SpeciesRegistry::getName( int id ){
+    lock_guard< mutex > lock( getMutex() );
+
+    if ( id < 0 || id >= getNames().size() )
+        return "";
+
+    return getNames()[ id ];
+}
+
+int SpeciesRegistry::size(){
+    lock_guard< mutex > lock( getMutex() );
+    return getNames().size();
+}
+
+unordered_map< string, int >& SpeciesRegistry::getIDs(){
+    static unordered_map< string, int > ids;
+    return ids;
+}
+
+vector< string >& SpeciesRegistry::getNames(){
+    static vector< string > names;
+    return names;
+}
+
+mutex& SpeciesRegistry::getMutex(){
+    static mutex m;
+    return m;
+}
@@ -0,0 +1,62 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+#ifndef SPECIES_REGISTRY_H
+#define SPECIES_REGISTRY_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+using namespace std;
+
+/** The species are interned to small integer IDs when the input is read (the initial species of the lattice,
+ * the reactants and the products of the processes) so that the sites and the processes compare and index
+ * integers. The names are needed only for the output. The registry is shared by all the simulations of the
+ * process (replicas and sweep points) so the same name always has the same ID. */
+
+class SpeciesRegistry
+{
+public:
+    /// The ID of a site without a species
+    static constexpr int NONE = -1;
+
+    /// Returns the ID of the species, adding it if it is not registered (NONE for an empty name)
+    static int intern( const string& name );
+
+    /// Returns the ID of the species or NONE if it is not registered
+    static int find( const string& name );
+
+    /// Returns the name of the species (empty for NONE)
+    static string getName( int id );
+
+    /// Returns the number of registered species
+    static int size();
+
+private:
+    /// The IDs of the names
+    static unordered_map< string, int >& getIDs();
+
+    /// The names indexed by their ID
+    static vector< string >& getNames();
+
+    /// Guards the tables since the replicas are initialized concurrently
+    static mutex& getMutex();
+};
+
+#endif // SPECIES_REGISTRY_H
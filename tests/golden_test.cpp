@@ -0,0 +1,349 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+/* Regression test of the physics of the kinetic engine.
+ *
+ * golden: runs a fixed-seed scenario through Apothesis::init/exec and compares the sequence of the events
+ *   (the process and the site of each one), the number of events and the class size of every process at the end
+ *   and the final heights and species of the lattice with a stored golden output. Any change of the selection,
+ *   the containers or the data layout that keeps the physics must reproduce it exactly.
+ *   With APOTHESIS_UPDATE_GOLDEN=1 the golden output is written instead of compared.
+ *
+ * ensemble: the engines that consume the random numbers differently (e.g. the n-fold engine or the rejection selection)
+ *   give other trajectories with the same statistics. The scenario runs as an ensemble with the reference and with the
+ *   candidate settings and every column (but the time) of the averaged output at the last log row common to both must agree within
+ *   four standard errors. The seeds are fixed so the result does not change from run to run.
+ *
+ * fires: runs the scenario and checks that a process performs events, i.e. that the processes whose names start with
+ *   the given name (e.g. every bin of an "all" process) have a positive number of events at the end.
+ *
+ * Usage: golden_test golden <input.kmc> <golden file> [input lines added to the input ...]
+ *        golden_test ensemble <input.kmc> <replicas> <reference input line> <candidate input line>
+ *        golden_test fires <input.kmc> <process> */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <filesystem>
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "apothesis.h"
+#include "lattice.h"
+#include "site.h"
+
+using namespace std;
+
+/// The largest difference of the ensemble means in standard errors
+const double MAX_STANDARD_ERRORS = 4.0;
+
+/// The table of Output.log: the names of the columns and the rows after them
+struct OutputTable {
+    vector<string> names;
+    vector< vector<string> > rows;
+};
+
+vector<string> splitTabs( const string& line )
+{
+    vector<string> items;
+    stringstream ss( line );
+    string item;
+    while ( getline( ss, item, '\t' ) )
+        if ( !item.empty() )
+            items.push_back( item );
+    return items;
+}
+
+bool readLines( const string& file, vector<string>& lines )
+{
+    ifstream in( file );
+    if ( !in.is_open() )
+        return false;
+
+    string line;
+    while ( getline( in, line ) )
+        lines.push_back( line );
+    return true;
+}
+
+bool readOutput( const string& file, OutputTable& table )
+{
+    vector<string> lines;
+    if ( !readLines( file, lines ) )
+        return false;
+
+    int header = -1;
+    for ( int l = 0; l < lines.size() && header < 0; l++ )
+        if ( lines[ l ].compare( 0, 8, "Time (s)" ) == 0 )
+            header = l;
+
+    if ( header < 0 )
+        return false;
+
+    table.names = splitTabs( lines[ header ] );
+    for ( int l = header + 1; l < lines.size(); l++ )
+        if ( !lines[ l ].empty() )
+            table.rows.push_back( splitTabs( lines[ l ] ) );
+
+    return !table.rows.empty();
+}
+
+/// Runs the scenario in a temporary directory. The input is the scenario followed by the lines.
+/// If result is given the events, the classes and the final lattice are written in it.
+bool runScenario( const string& scenario, const vector<string>& lines, ostream* result, OutputTable& table )
+{
+    vector<string> input;
+    if ( !readLines( scenario, input ) ){
+        cerr << "Cannot open the scenario " << scenario << endl;
+        return false;
+    }
+
+    char dir[] = "/tmp/apothesis_test.XXXXXX";
+    if ( !mkdtemp( dir ) ){
+        cerr << "Cannot create a temporary directory" << endl;
+        return false;
+    }
+
+    string cwd = filesystem::current_path();
+    filesystem::current_path( dir );
+
+    ofstream out( "input.kmc" );
+    for ( string& line:input )
+        out << line << "\n";
+    for ( const string& line:lines )
+        out << line << "\n";
+    out.close();
+
+    //The output of the simulation is not part of the test
+    freopen( "stdout.txt", "w", stdout );
+
+    char name[] = "apothesis";
+    char* argv[] = { name, nullptr };
+
+    stringstream events;
+    Apothesis* apothesis = new Apothesis( 1, argv );
+    apothesis->init();
+    if ( result )
+        apothesis->setEventTrace( &events );
+    apothesis->exec();
+
+    //The final lattice
+    stringstream heights, species;
+    Lattice* lattice = apothesis->pLattice;
+    vector<Site*> sites = lattice->getSites();
+    for ( int i = 0; i < lattice->getSize(); i++ ){
+        string label = sites[ i ]->getLabelName();
+        heights << ( i%lattice->getX() ? " " : "" ) << sites[ i ]->getHeight();
+        species << ( i%lattice->getX() ? " " : "" ) << ( label.empty() ? "-" : label );
+        if ( ( i + 1 )%lattice->getX() == 0 ){
+            heights << "\n";
+            species << "\n";
+        }
+    }
+
+    int x = lattice->getX(), y = lattice->getY();
+    long numEvents = apothesis->getNumEvents();
+
+    //Output.log is complete when the simulation is deleted
+    delete apothesis;
+
+    bool ok = readOutput( "Output.log", table );
+    if ( !ok )
+        cerr << "No output was written in " << dir << endl;
+
+    if ( ok && result ){
+        *result << "events " << numEvents << "\n" << events.str();
+
+        //The number of events and the class size of every process at the end
+        *result << "classes\n";
+        const vector<string>& last = table.rows.back();
+        for ( int c = 0; c < table.names.size(); c++ )
+            for ( int k = 0; k < table.names.size(); k++ )
+                if ( table.names[ k ] == table.names[ c ] + " (class size)" )
+                    *result << table.names[ c ] << "\t" << last[ c ] << "\t" << last[ k ] << "\n";
+
+        *result << "heights " << x << " " << y << "\n" << heights.str() << "species\n" << species.str();
+    }
+
+    filesystem::current_path( cwd );
+    if ( ok )
+        filesystem::remove_all( dir );
+    return ok;
+}
+
+int testGolden( const string& scenario, const string& golden, const vector<string>& lines )
+{
+    stringstream result;
+    OutputTable table;
+    if ( !runScenario( scenario, lines, &result, table ) )
+        return 1;
+
+    const char* update = getenv( "APOTHESIS_UPDATE_GOLDEN" );
+    if ( update && string( update ) == "1" ){
+        ofstream out( golden );
+        out << result.str();
+        cerr << "Golden output written in " << golden << endl;
+        return 0;
+    }
+
+    vector<string> expected;
+    if ( !readLines( golden, expected ) ){
+        cerr << "Cannot open the golden output " << golden << " (run with APOTHESIS_UPDATE_GOLDEN=1 to write it)" << endl;
+        return 1;
+    }
+
+    vector<string> got;
+    string line;
+    while ( getline( result, line ) )
+        got.push_back( line );
+
+    //The differences are reported in the section (events, classes, heights or species) they are found
+    int differences = 0;
+    string section = "events";
+    for ( int l = 0; l < max( expected.size(), got.size() ); l++ ){
+        string e = l < expected.size() ? expected[ l ] : "(end)";
+        string g = l < got.size() ? got[ l ] : "(end)";
+
+        if ( e.compare( 0, 7, "classes" ) == 0 || e.compare( 0, 7, "heights" ) == 0 || e.compare( 0, 7, "species" ) == 0 )
+            section = e.substr( 0, 7 );
+
+        if ( e != g ){
+            if ( differences < 10 )
+                cerr << golden << ":" << l + 1 << " (" << section << "): expected \"" << e << "\" got \"" << g << "\"" << endl;
+            differences++;
+        }
+    }
+
+    if ( differences > 0 ){
+        cerr << differences << " lines differ from the golden output" << endl;
+        return 1;
+    }
+
+    cerr << "Same as the golden output (" << got.size() << " lines)" << endl;
+    return 0;
+}
+
+int testEnsemble( const string& scenario, int replicas, const string& reference, const string& candidate )
+{
+    string ensemble = "ensemble: " + to_string( replicas ) + " 1";
+
+    OutputTable ref, cand;
+    if ( !runScenario( scenario, { ensemble, reference }, nullptr, ref ) ||
+         !runScenario( scenario, { ensemble, candidate }, nullptr, cand ) )
+        return 1;
+
+    //The last row of each replica is written at the end of its run. The one before is a log row in all of them.
+    int rows = min( ref.rows.size(), cand.rows.size() );
+    int row = max( rows - 2, 0 );
+
+    int failed = 0;
+    cerr << setw( 48 ) << left << "column" << right << setw( 14 ) << "reference" << setw( 14 ) << "candidate" << setw( 10 ) << "z" << endl;
+    //The time is not compared: a replica that can perform no more events jumps to an infinite time with the n-fold engine
+    for ( int c = 2; c + 1 < ref.names.size(); c += 2 ){
+        int k = find( cand.names.begin(), cand.names.end(), ref.names[ c ] ) - cand.names.begin();
+        if ( k + 1 >= cand.names.size() ){
+            cerr << "The column " << ref.names[ c ] << " is missing from the candidate" << endl;
+            return 1;
+        }
+
+        double m1 = stod( ref.rows[ row ][ c ] ), se1 = stod( ref.rows[ row ][ c + 1 ] );
+        double m2 = stod( cand.rows[ row ][ k ] ), se2 = stod( cand.rows[ row ][ k + 1 ] );
+        double se = sqrt( se1*se1 + se2*se2 );
+
+        bool same;
+        if ( !isfinite( m1 ) || !isfinite( m2 ) || !isfinite( se ) )
+            same = m1 == m2;
+        else if ( se > 0.0 )
+            same = fabs( m1 - m2 ) <= MAX_STANDARD_ERRORS*se;
+        else
+            same = fabs( m1 - m2 ) <= 1.0e-9*max( fabs( m1 ), fabs( m2 ) );
+        if ( !same )
+            failed++;
+
+        cerr << setw( 48 ) << left << ref.names[ c ].substr( 0, 47 ) << right << setw( 14 ) << m1 << setw( 14 ) << m2
+             << setw( 10 ) << setprecision( 3 ) << ( se > 0.0 ? fabs( m1 - m2 )/se : 0.0 ) << setprecision( 6 )
+             << ( same ? "" : "  <- differs" ) << endl;
+    }
+
+    if ( failed > 0 ){
+        cerr << failed << " columns differ by more than " << MAX_STANDARD_ERRORS << " standard errors" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int testFires( const string& scenario, const string& process )
+{
+    OutputTable table;
+    if ( !runScenario( scenario, {}, nullptr, table ) )
+        return 1;
+
+    //The columns of the process (one for each bin) but not their class sizes
+    const string size = " (class size)";
+    const vector<string>& last = table.rows.back();
+    int columns = 0;
+    double events = 0.0;
+    for ( int c = 0; c < table.names.size() && c < last.size(); c++ ){
+        const string& name = table.names[ c ];
+        if ( name.compare( 0, process.size(), process ) != 0 ||
+             ( name.size() >= size.size() && name.compare( name.size() - size.size(), size.size(), size ) == 0 ) )
+            continue;
+
+        cerr << name << "\t" << last[ c ] << endl;
+        events += stod( last[ c ] );
+        columns++;
+    }
+
+    if ( columns == 0 ){
+        cerr << "There is no process " << process << " in the output" << endl;
+        return 1;
+    }
+
+    if ( events <= 0.0 ){
+        cerr << "The process " << process << " performed no events" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int main( int argc, char* argv[] )
+{
+    string mode = argc > 1 ? argv[ 1 ] : "";
+
+    if ( mode == "golden" && argc >= 4 )
+        return testGolden( argv[ 2 ], argv[ 3 ], vector<string>( argv + 4, argv + argc ) );
+
+    if ( mode == "ensemble" && argc == 6 )
+        return testEnsemble( argv[ 2 ], atoi( argv[ 3 ] ), argv[ 4 ], argv[ 5 ] );
+
+    if ( mode == "fires" && argc == 4 )
+        return testFires( argv[ 2 ], argv[ 3 ] );
+
+    cerr << "Usage: golden_test golden <input.kmc> <golden file> [input lines ...]" << endl
+         << "       golden_test ensemble <input.kmc> <replicas> <reference input line> <candidate input line>" << endl
+         << "       golden_test fires <input.kmc> <process>" << endl;
+    return 1;
+}
@@ -0,0 +1,81 @@
+//============================================================================
+//    Apothesis: A kinetic Monte Calro (KMC) code for deposition processes.
+//    Copyright (C) 2019  Nikolaos (Nikos) Cheimarios
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//============================================================================
+
+
+/* Converts a binary trajectory (write: trajectory) to the text files of the lattice snapshots
+ * (Height_<time>.dat and SurfaceSpecies_<time>.dat), the same as the ones written without the trajectory.
+ *
+ * Usage: apothesis_traj info <trajectory>           lists the frames
+ *        apothesis_traj text <trajectory> [dir]     writes the text files in dir (default the current directory) */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include "trajectory.h"
+#include "lattice_text.h"
+
+using namespace std;
+using namespace Utils;
+
+int main( int argc, char* argv[] )
+{
+    if ( argc < 3 || ( string( argv[ 1 ] ) != "info" && string( argv[ 1 ] ) != "text" ) ){
+        cerr << "Usage: " << argv[ 0 ] << " info <trajectory>" << endl
+             << "       " << argv[ 0 ] << " text <trajectory> [dir]" << endl;
+        return 1;
+    }
+
+    TrajectoryReader reader;
+    if ( !reader.open( argv[ 2 ] ) ){
+        cerr << reader.getError() << endl;
+        return 1;
+    }
+
+    if ( string( argv[ 1 ] ) == "info" ){
+        cout << "Lattice " << reader.getX() << " x " << reader.getY() << ", " << reader.size() << " frames" << endl;
+        cout << setw( 8 ) << "frame" << setw( 24 ) << "time (s)" << setw( 16 ) << "offset" << setw( 10 ) << "planes" << setw( 10 ) << "keyframe" << endl;
+
+        int i = 0;
+        for ( const TrajectoryReader::Entry& entry:reader.getEntries() ){
+            string planes = string( entry.planes & TrajectoryWriter::HEIGHTS ? "H" : "" ) + ( entry.planes & TrajectoryWriter::SPECIES ? "S" : "" );
+            cout << setw( 8 ) << i++ << setw( 24 ) << setprecision( 15 ) << entry.time << setw( 16 ) << entry.offset
+                 << setw( 10 ) << planes << setw( 10 ) << ( entry.rawPlanes == entry.planes ? "yes" : "" ) << endl;
+        }
+
+        return 0;
+    }
+
+    string dir = argc > 3 ? string( argv[ 3 ] ) + "/" : "";
+
+    TrajectoryFrame frame;
+    for ( int i = 0; i < reader.size(); i++ ){
+        if ( !reader.read( i, frame ) ){
+            cerr << reader.getError() << endl;
+            return 1;
+        }
+
+        if ( frame.planes & TrajectoryWriter::HEIGHTS )
+            writeHeightsText( dir + latticeFileName( "Height", frame.time ), frame.time, reader.getX(), reader.getY(), frame.heights );
+
+        if ( frame.planes & TrajectoryWriter::SPECIES )
+            writeSpeciesText( dir + latticeFileName( "SurfaceSpecies", frame.time ), frame.time, reader.getX(), reader.getY(), frame.labels, frame.names );
+    }
+
+    cout << reader.size() << " frames written" << endl;
+    return 0;
+}